@@ -0,0 +1,26 @@
+//! Enables the AVX-512 stage-one kernel (`cfg(nsv_avx512)`) on toolchains
+//! that have stable AVX-512 intrinsics (rustc 1.89 and later). Older
+//! toolchains build with the AVX2 and scalar kernels only.
+
+use std::env;
+use std::process::Command;
+
+fn rustc_minor_version() -> Option<u32> {
+    let rustc = env::var_os("RUSTC")?;
+    let output = Command::new(rustc).arg("--version").output().ok()?;
+    let version = String::from_utf8(output.stdout).ok()?;
+    // "rustc 1.89.0 (29483883e 2025-08-04)"
+    let mut parts = version.split_whitespace().nth(1)?.split('.');
+    if parts.next()? != "1" {
+        return None;
+    }
+    parts.next()?.parse().ok()
+}
+
+fn main() {
+    println!("cargo:rerun-if-changed=build.rs");
+    println!("cargo:rustc-check-cfg=cfg(nsv_avx512)");
+    if rustc_minor_version().map_or(false, |minor| minor >= 89) {
+        println!("cargo:rustc-cfg=nsv_avx512");
+    }
+}
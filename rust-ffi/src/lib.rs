@@ -2,15 +2,26 @@
 //!
 //! Two API surfaces:
 //! - `SampleHandle` — eager decode of a prefix (header + sample rows) for type sniffing.
-//! - `nsv_decode_flat` — zero-allocation flat-buffer decode (scan-time, hot path).
+//! - `nsv_decode_columns` — decode straight into DuckDB vectors (scan-time, hot path).
+//! - `nsv_decode_flat` — zero-allocation flat-buffer decode into offset/length arrays.
+//! - `nsv_count_rows` — row count of a range without decoding (`COUNT(*)`).
+//! - `nsv_detect_compression`, `nsv_zstd_seek_table`, `nsv_zstd_seekable_frames` —
+//!   framing of compressed files; the gzip/zstd codecs themselves are DuckDB's.
 //!
 //! Memory model:
 //! - `nsv_decode_sample` returns an owned `*mut SampleHandle`; free with `nsv_sample_free`.
-//! - `nsv_decode_flat` writes into caller-provided arrays; unescaped cells go into a
-//!   `NsvScratchBuf` that the caller frees with `nsv_scratch_free`.
+//! - `nsv_decode_flat` writes into caller-provided arrays; unescaped cells are appended
+//!   to a `NsvScratchBuf` the caller creates once with `nsv_scratch_new`, empties with
+//!   `nsv_scratch_reset` between batches and frees with `nsv_scratch_free`. Its memory
+//!   comes from the caller's `NsvAllocator` when one is passed, so the host can
+//!   account for it.
+//! - `nsv_decode_columns` writes into caller-owned vector memory. Its strings point
+//!   into the input or into the scratch buffer, which `nsv_scratch_detach` hands
+//!   over to the caller so the strings can outlive the next batch.
 
+use std::alloc::Layout;
 use std::ffi::CString;
-use std::os::raw::c_char;
+use std::os::raw::{c_char, c_void};
 
 // ── Sample decode (bind-time: header + type sniffing) ───────────────
 
@@ -85,6 +96,302 @@ pub extern "C" fn nsv_sample_free(handle: *mut SampleHandle) {
     }
 }
 
+// ── Structural index (stage one of the decoder) ────────────────────
+//
+// Only two bytes matter to NSV's structure: `\n` ends a cell (or, on an
+// empty line, a row) and `\` marks a cell that needs unescaping. Stage one
+// turns a window of input into one newline and one backslash bitmask per
+// 64-byte block with the widest SIMD compare the CPU has; stage two
+// (`Structure`) walks the set bits instead of the bytes.
+
+/// Blocks of 64 bytes indexed per stage-one call (4 KiB, stays in L1).
+const INDEX_BLOCKS: usize = 64;
+
+/// Stage-one kernel: fills `newlines[i]` and `backslashes[i]` (bit j = byte
+/// j) for each 64-byte block i of `input`, whose length is a multiple of 64.
+type BlockMasks = fn(&[u8], &mut [u64], &mut [u64]);
+
+/// Bitmask of the `byte` bytes in a 64-byte block (bit i = byte i).
+///
+/// Written as a plain loop over a fixed-size array so it compiles to
+/// compare + movemask on SIMD targets.
+#[inline(always)]
+fn byte_mask(block: &[u8; 64], byte: u8) -> u64 {
+    let mut mask = 0u64;
+    for (i, &b) in block.iter().enumerate() {
+        mask |= ((b == byte) as u64) << i;
+    }
+    mask
+}
+
+fn block_masks_scalar(input: &[u8], newlines: &mut [u64], backslashes: &mut [u64]) {
+    for (i, block) in input.chunks_exact(64).enumerate() {
+        let block = block.try_into().unwrap();
+        newlines[i] = byte_mask(block, b'\n');
+        backslashes[i] = byte_mask(block, b'\\');
+    }
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "avx2")]
+unsafe fn block_masks_avx2(input: &[u8], newlines: &mut [u64], backslashes: &mut [u64]) {
+    use std::arch::x86_64::*;
+    let nl = _mm256_set1_epi8(b'\n' as i8);
+    let bs = _mm256_set1_epi8(b'\\' as i8);
+    for (i, block) in input.chunks_exact(64).enumerate() {
+        let lo = _mm256_loadu_si256(block.as_ptr().cast());
+        let hi = _mm256_loadu_si256(block.as_ptr().add(32).cast());
+        let nl_lo = _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, nl)) as u32 as u64;
+        let nl_hi = _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, nl)) as u32 as u64;
+        let bs_lo = _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, bs)) as u32 as u64;
+        let bs_hi = _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, bs)) as u32 as u64;
+        newlines[i] = nl_lo | nl_hi << 32;
+        backslashes[i] = bs_lo | bs_hi << 32;
+    }
+}
+
+// AVX-512 intrinsics are stable from rustc 1.89 on; build.rs sets
+// `nsv_avx512` for such toolchains.
+#[cfg(all(target_arch = "x86_64", nsv_avx512))]
+#[target_feature(enable = "avx512bw")]
+unsafe fn block_masks_avx512(input: &[u8], newlines: &mut [u64], backslashes: &mut [u64]) {
+    use std::arch::x86_64::*;
+    let nl = _mm512_set1_epi8(b'\n' as i8);
+    let bs = _mm512_set1_epi8(b'\\' as i8);
+    for (i, block) in input.chunks_exact(64).enumerate() {
+        let v = _mm512_loadu_si512(block.as_ptr().cast());
+        newlines[i] = _mm512_cmpeq_epi8_mask(v, nl);
+        backslashes[i] = _mm512_cmpeq_epi8_mask(v, bs);
+    }
+}
+
+#[cfg(target_arch = "aarch64")]
+fn block_masks_neon(input: &[u8], newlines: &mut [u64], backslashes: &mut [u64]) {
+    use std::arch::aarch64::*;
+    // NEON has no movemask: keep one bit weight per lane and add them up.
+    const WEIGHTS: [u8; 16] = [1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128];
+    unsafe fn mask(chunks: &[uint8x16_t; 4], needle: uint8x16_t, weights: uint8x16_t) -> u64 {
+        let mut mask = 0u64;
+        for (k, &chunk) in chunks.iter().enumerate() {
+            let bits = vandq_u8(vceqq_u8(chunk, needle), weights);
+            let lo = vaddv_u8(vget_low_u8(bits)) as u64;
+            let hi = vaddv_u8(vget_high_u8(bits)) as u64;
+            mask |= (lo | hi << 8) << (16 * k);
+        }
+        mask
+    }
+    unsafe {
+        let weights = vld1q_u8(WEIGHTS.as_ptr());
+        let nl = vdupq_n_u8(b'\n');
+        let bs = vdupq_n_u8(b'\\');
+        for (i, block) in input.chunks_exact(64).enumerate() {
+            let p = block.as_ptr();
+            let chunks = [vld1q_u8(p), vld1q_u8(p.add(16)), vld1q_u8(p.add(32)), vld1q_u8(p.add(48))];
+            newlines[i] = mask(&chunks, nl, weights);
+            backslashes[i] = mask(&chunks, bs, weights);
+        }
+    }
+}
+
+/// Stage-one kernels this CPU can run, scalar first and fastest last.
+fn block_mask_kernels() -> Vec<(&'static str, BlockMasks)> {
+    let mut kernels: Vec<(&'static str, BlockMasks)> = vec![("scalar", block_masks_scalar)];
+    #[cfg(target_arch = "x86_64")]
+    {
+        if is_x86_feature_detected!("avx2") {
+            kernels.push(("avx2", |input, newlines, backslashes| unsafe {
+                block_masks_avx2(input, newlines, backslashes)
+            }));
+        }
+        #[cfg(nsv_avx512)]
+        if is_x86_feature_detected!("avx512bw") {
+            kernels.push(("avx512", |input, newlines, backslashes| unsafe {
+                block_masks_avx512(input, newlines, backslashes)
+            }));
+        }
+    }
+    #[cfg(target_arch = "aarch64")]
+    kernels.push(("neon", block_masks_neon));
+    kernels
+}
+
+/// The fastest stage-one kernel, picked once per process.
+fn block_masks() -> BlockMasks {
+    static KERNEL: std::sync::OnceLock<BlockMasks> = std::sync::OnceLock::new();
+    *KERNEL.get_or_init(|| block_mask_kernels().last().unwrap().1)
+}
+
+/// Software prefetch of `bytes`, one cache line at a time (x86-64 only;
+/// elsewhere the hardware prefetcher is left to it).
+#[inline(always)]
+fn prefetch(bytes: &[u8]) {
+    #[cfg(target_arch = "x86_64")]
+    for line in bytes.chunks(64) {
+        use std::arch::x86_64::*;
+        unsafe { _mm_prefetch::<_MM_HINT_T0>(line.as_ptr().cast()) };
+    }
+    #[cfg(not(target_arch = "x86_64"))]
+    let _ = bytes;
+}
+
+/// Stage two's view of the input: its newlines in order, indexed one window
+/// of `INDEX_BLOCKS` blocks at a time. Stage one runs a window ahead of the
+/// cells the sink materializes, and each window it indexes has the bytes of
+/// the next one prefetched, so those are in cache by the time the sink is
+/// done with this one.
+struct Structure<'a> {
+    input: &'a [u8],
+    kernel: BlockMasks,
+    newlines: [u64; INDEX_BLOCKS],
+    backslashes: [u64; INDEX_BLOCKS],
+    /// Offset of the indexed window and the blocks it holds (the last one
+    /// zero-padded at the end of the input).
+    window: usize,
+    blocks: usize,
+    /// Current block of the window, and its newlines not yet visited.
+    block: usize,
+    bits: u64,
+    /// Bit 0 set if the byte before the window is a newline.
+    carry: u64,
+}
+
+impl<'a> Structure<'a> {
+    fn new(input: &'a [u8], kernel: BlockMasks) -> Self {
+        let mut structure = Structure {
+            input,
+            kernel,
+            newlines: [0; INDEX_BLOCKS],
+            backslashes: [0; INDEX_BLOCKS],
+            window: 0,
+            blocks: 0,
+            block: 0,
+            bits: 0,
+            carry: 0,
+        };
+        structure.index(0);
+        structure
+    }
+
+    /// Run stage one over the window starting at `offset`; false at the end
+    /// of the input.
+    fn index(&mut self, offset: usize) -> bool {
+        let rest = &self.input[offset.min(self.input.len())..];
+        if rest.is_empty() {
+            return false;
+        }
+        let full = (rest.len() / 64).min(INDEX_BLOCKS);
+        (self.kernel)(
+            &rest[..full * 64],
+            &mut self.newlines[..full],
+            &mut self.backslashes[..full],
+        );
+        let ahead = &rest[full * 64..];
+        prefetch(&ahead[..ahead.len().min(64 * INDEX_BLOCKS)]);
+        let mut blocks = full;
+        if full < INDEX_BLOCKS && rest.len() > full * 64 {
+            let mut block = [0u8; 64];
+            block[..rest.len() - full * 64].copy_from_slice(&rest[full * 64..]);
+            (self.kernel)(
+                &block,
+                &mut self.newlines[full..full + 1],
+                &mut self.backslashes[full..full + 1],
+            );
+            blocks += 1;
+        }
+        self.window = offset;
+        self.blocks = blocks;
+        self.block = 0;
+        self.bits = self.newlines[0];
+        true
+    }
+
+    /// Move on to the next block, indexing the next window if needed.
+    fn advance(&mut self) -> bool {
+        if self.block + 1 < self.blocks {
+            self.block += 1;
+            self.bits = self.newlines[self.block];
+            return true;
+        }
+        if self.blocks == 0 {
+            return false;
+        }
+        self.carry = self.newlines[self.blocks - 1] >> 63;
+        self.index(self.window + self.blocks * 64)
+    }
+
+    #[inline(always)]
+    fn block_offset(&self) -> usize {
+        self.window + self.block * 64
+    }
+
+    /// Offset of the next newline.
+    #[inline(always)]
+    fn next_newline(&mut self) -> Option<usize> {
+        while self.bits == 0 {
+            if !self.advance() {
+                return None;
+            }
+        }
+        let bit = self.bits.trailing_zeros() as usize;
+        self.bits &= self.bits - 1;
+        Some(self.block_offset() + bit)
+    }
+
+    /// Skip to the next newline that directly follows another one, i.e. the
+    /// empty line that ends the current row. None if the row runs to the
+    /// end of the input.
+    fn skip_to_row_end(&mut self) -> Option<usize> {
+        loop {
+            let m = self.newlines[self.block];
+            let before = if self.block > 0 {
+                self.newlines[self.block - 1] >> 63
+            } else {
+                self.carry
+            };
+            let ends = m & ((m << 1) | before) & self.bits;
+            if ends != 0 {
+                let bit = ends.trailing_zeros() as usize;
+                self.bits &= !(u64::MAX >> (63 - bit));
+                return Some(self.block_offset() + bit);
+            }
+            if !self.advance() {
+                return None;
+            }
+        }
+    }
+
+    /// Whether `input[start..end]` holds a backslash; `end` is in the
+    /// current block.
+    #[inline(always)]
+    fn has_backslash(&self, start: usize, end: usize) -> bool {
+        let base = self.block_offset();
+        if start >= base {
+            // The usual case: the whole cell is in the current block.
+            let m = self.backslashes[self.block] >> (start - base);
+            return m & ((1u64 << (end - start)) - 1) != 0;
+        }
+        if start < self.window {
+            // The cell began in an earlier window.
+            return self.input[start..end].contains(&b'\\');
+        }
+        let first = (start - self.window) / 64;
+        let last = (end - self.window) / 64;
+        for b in first..=last {
+            let mut m = self.backslashes[b];
+            if b == first {
+                m &= u64::MAX << ((start - self.window) % 64);
+            }
+            if b == last {
+                m &= (1u64 << ((end - self.window) % 64)) - 1;
+            }
+            if m != 0 {
+                return true;
+            }
+        }
+        false
+    }
+}
+
 // ── Flat-buffer decode (zero-allocation scan) ──────────────────────
 //
 // Writes cell locations into caller-provided flat arrays. For cells
@@ -97,9 +404,229 @@ pub extern "C" fn nsv_sample_free(handle: *mut SampleHandle) {
 
 const SCRATCH_BIT: usize = 1 << (usize::BITS - 1);
 
-/// Scratch buffer for unescaped cell data.
+/// Allocation callbacks supplied by the host. `realloc` keeps the first
+/// `old_size` bytes. A callback returns null when the allocation fails; the
+/// decode call then gives up and returns 0.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct NsvAllocator {
+    pub ctx: *mut c_void,
+    pub alloc: extern "C" fn(ctx: *mut c_void, size: usize) -> *mut u8,
+    pub realloc: extern "C" fn(
+        ctx: *mut c_void,
+        ptr: *mut u8,
+        old_size: usize,
+        new_size: usize,
+    ) -> *mut u8,
+    pub free: extern "C" fn(ctx: *mut c_void, ptr: *mut u8, size: usize),
+}
+
+/// Smallest scratch allocation; the buffer doubles from there.
+const SCRATCH_MIN_CAPACITY: usize = 4096;
+/// Largest capacity `nsv_scratch_reset` keeps; a bigger buffer (grown for a
+/// batch of huge cells) is released instead.
+const SCRATCH_RETAIN_MAX: usize = 16 << 20;
+
+/// Escaped cells at least this long are unescaped into an allocation of
+/// their own (see `nsv_scratch_detach_large`) rather than into scratch, so a
+/// huge cell is neither copied again as scratch grows nor kept around in a
+/// retained scratch buffer.
+const LARGE_CELL_BYTES: usize = 64 * 1024;
+
+/// Growable bytes for unescaped cells. Nothing is allocated until the first
+/// escaped cell.
+struct ScratchBytes {
+    ptr: *mut u8,
+    len: usize,
+    cap: usize,
+    allocator: Option<NsvAllocator>,
+}
+
+impl ScratchBytes {
+    fn new(allocator: Option<NsvAllocator>) -> Self {
+        ScratchBytes {
+            ptr: std::ptr::null_mut(),
+            len: 0,
+            cap: 0,
+            allocator,
+        }
+    }
+
+    fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Make room for `additional` more bytes; false if the buffer could not
+    /// grow.
+    fn reserve(&mut self, additional: usize) -> bool {
+        let needed = self.len + additional;
+        needed <= self.cap || self.grow(needed)
+    }
+
+    /// Append escaped cell `bytes` unescaped, in one pass straight into the
+    /// buffer. Returns the unescaped length, or None if the buffer could not
+    /// grow.
+    fn extend_unescaped(&mut self, bytes: &[u8]) -> Option<usize> {
+        if bytes.is_empty() {
+            return Some(0);
+        }
+        if !self.reserve(bytes.len()) {
+            return None;
+        }
+        let written = match unescape_simple(bytes, unsafe { self.ptr.add(self.len) }) {
+            Some(written) => written,
+            None => {
+                let unescaped = nsv::unescape_bytes(bytes);
+                if !self.reserve(unescaped.len()) {
+                    return None;
+                }
+                unsafe {
+                    std::ptr::copy_nonoverlapping(
+                        unescaped.as_ptr(),
+                        self.ptr.add(self.len),
+                        unescaped.len(),
+                    )
+                };
+                unescaped.len()
+            }
+        };
+        self.len += written;
+        Some(written)
+    }
+
+    fn grow(&mut self, needed: usize) -> bool {
+        let new_cap = needed.max(self.cap * 2).max(SCRATCH_MIN_CAPACITY);
+        let new_ptr = match self.allocator {
+            Some(a) if self.ptr.is_null() => (a.alloc)(a.ctx, new_cap),
+            Some(a) => (a.realloc)(a.ctx, self.ptr, self.cap, new_cap),
+            None => match Layout::array::<u8>(new_cap) {
+                Ok(layout) if self.ptr.is_null() => unsafe { std::alloc::alloc(layout) },
+                Ok(_) => unsafe {
+                    std::alloc::realloc(self.ptr, Layout::array::<u8>(self.cap).unwrap(), new_cap)
+                },
+                Err(_) => std::ptr::null_mut(),
+            },
+        };
+        if new_ptr.is_null() {
+            return false;
+        }
+        self.ptr = new_ptr;
+        self.cap = new_cap;
+        true
+    }
+
+    fn release(&mut self) {
+        if self.ptr.is_null() {
+            return;
+        }
+        match self.allocator {
+            Some(a) => (a.free)(a.ctx, self.ptr, self.cap),
+            None => unsafe {
+                std::alloc::dealloc(self.ptr, Layout::array::<u8>(self.cap).unwrap())
+            },
+        }
+        self.ptr = std::ptr::null_mut();
+        self.len = 0;
+        self.cap = 0;
+    }
+}
+
+/// Unescape `bytes` into `dst` (room for `bytes.len()`), copying the runs
+/// between escapes in bulk. Returns the unescaped length, or None if `bytes`
+/// has a backslash other than `\\` or `\n` (left to `nsv::unescape_bytes`).
+fn unescape_simple(bytes: &[u8], dst: *mut u8) -> Option<usize> {
+    let mut written = 0;
+    let mut rest = bytes;
+    while let Some(pos) = rest.iter().position(|&b| b == b'\\') {
+        let byte = match rest.get(pos + 1) {
+            Some(b'\\') => b'\\',
+            Some(b'n') => b'\n',
+            _ => return None,
+        };
+        unsafe {
+            std::ptr::copy_nonoverlapping(rest.as_ptr(), dst.add(written), pos);
+            *dst.add(written + pos) = byte;
+        }
+        written += pos + 1;
+        rest = &rest[pos + 2..];
+    }
+    unsafe { std::ptr::copy_nonoverlapping(rest.as_ptr(), dst.add(written), rest.len()) };
+    Some(written + rest.len())
+}
+
+impl Drop for ScratchBytes {
+    fn drop(&mut self) {
+        self.release();
+    }
+}
+
+/// Column map of the last projection decoded: `map[original_col]` is the
+/// projected index, or usize::MAX to skip the column.
+#[derive(Default)]
+struct ColumnMap {
+    columns: Vec<usize>,
+    map: Vec<usize>,
+    max_col: usize,
+}
+
+impl ColumnMap {
+    /// Map for `columns`, rebuilt only when the projection changes.
+    fn get(&mut self, columns: &[usize]) -> (&[usize], usize) {
+        if self.columns != columns {
+            self.max_col = columns.iter().copied().max().unwrap_or(0);
+            self.map.clear();
+            self.map.resize(self.max_col + 1, usize::MAX);
+            for (proj_idx, &orig_col) in columns.iter().enumerate() {
+                self.map[orig_col] = proj_idx;
+            }
+            self.columns.clear();
+            self.columns.extend_from_slice(columns);
+        }
+        (&self.map, self.max_col)
+    }
+}
+
+/// Per-thread decode state, kept across decode calls so a steady-state scan
+/// does not allocate: the unescaped cells of the current batch, the column
+/// map, and (`nsv_decode_columns`) the strings to point at scratch once it
+/// has stopped moving, and the large cells with their projected column.
 pub struct NsvScratchBuf {
-    data: Vec<u8>,
+    bytes: ScratchBytes,
+    columns: ColumnMap,
+    fixups: Vec<ScratchFixup>,
+    large: Vec<(usize, ScratchBytes)>,
+}
+
+/// Create a scratch buffer that allocates through `allocator` (null: Rust's
+/// allocator). Free with `nsv_scratch_free`.
+#[no_mangle]
+pub extern "C" fn nsv_scratch_new(allocator: *const NsvAllocator) -> *mut NsvScratchBuf {
+    let allocator = if allocator.is_null() {
+        None
+    } else {
+        Some(unsafe { *allocator })
+    };
+    Box::into_raw(Box::new(NsvScratchBuf {
+        bytes: ScratchBytes::new(allocator),
+        columns: ColumnMap::default(),
+        fixups: Vec::new(),
+        large: Vec::new(),
+    }))
+}
+
+/// Drop the unescaped cells of the previous batch, keeping the capacity.
+#[no_mangle]
+pub extern "C" fn nsv_scratch_reset(buf: *mut NsvScratchBuf) {
+    if buf.is_null() {
+        return;
+    }
+    let buf = unsafe { &mut *buf };
+    buf.large.clear();
+    let bytes = &mut buf.bytes;
+    if bytes.cap > SCRATCH_RETAIN_MAX {
+        bytes.release();
+    }
+    bytes.len = 0;
 }
 
 #[no_mangle]
@@ -107,7 +634,66 @@ pub extern "C" fn nsv_scratch_ptr(buf: *const NsvScratchBuf) -> *const u8 {
     if buf.is_null() {
         return std::ptr::null();
     }
-    unsafe { &*buf }.data.as_ptr()
+    unsafe { &*buf }.bytes.ptr
+}
+
+/// Bytes of unescaped cells in the scratch buffer.
+#[no_mangle]
+pub extern "C" fn nsv_scratch_len(buf: *const NsvScratchBuf) -> usize {
+    if buf.is_null() {
+        return 0;
+    }
+    unsafe { &*buf }.bytes.len
+}
+
+/// Hand the scratch allocation to the caller, who frees it through the same
+/// `NsvAllocator` (`*out_size` bytes). The buffer starts over empty. Returns
+/// null if it holds no cells or uses Rust's allocator.
+#[no_mangle]
+pub extern "C" fn nsv_scratch_detach(buf: *mut NsvScratchBuf, out_size: *mut usize) -> *mut u8 {
+    if buf.is_null() || out_size.is_null() {
+        return std::ptr::null_mut();
+    }
+    let bytes = &mut unsafe { &mut *buf }.bytes;
+    if bytes.len == 0 || bytes.allocator.is_none() {
+        return std::ptr::null_mut();
+    }
+    let ptr = bytes.ptr;
+    unsafe { *out_size = bytes.cap };
+    bytes.ptr = std::ptr::null_mut();
+    bytes.len = 0;
+    bytes.cap = 0;
+    ptr
+}
+
+/// Hand the allocation of one large cell of the last `nsv_decode_columns`
+/// call to the caller, like `nsv_scratch_detach`; `*out_column` receives
+/// its projected column. Returns null once there are none left, or if the
+/// buffer uses Rust's allocator.
+#[no_mangle]
+pub extern "C" fn nsv_scratch_detach_large(
+    buf: *mut NsvScratchBuf,
+    out_size: *mut usize,
+    out_column: *mut usize,
+) -> *mut u8 {
+    if buf.is_null() || out_size.is_null() || out_column.is_null() {
+        return std::ptr::null_mut();
+    }
+    let buf = unsafe { &mut *buf };
+    if buf.bytes.allocator.is_none() {
+        return std::ptr::null_mut();
+    }
+    let Some((column, mut cell)) = buf.large.pop() else {
+        return std::ptr::null_mut();
+    };
+    let ptr = cell.ptr;
+    unsafe {
+        *out_size = cell.cap;
+        *out_column = column;
+    }
+    cell.ptr = std::ptr::null_mut();
+    cell.cap = 0;
+    ptr
 }
 
 #[no_mangle]
@@ -117,14 +703,153 @@ pub extern "C" fn nsv_scratch_free(buf: *mut NsvScratchBuf) {
     }
 }
 
-/// Build a column-map: col_map[original_col] = projected_index (or usize::MAX to skip).
-fn build_col_map(columns: &[usize]) -> (Vec<usize>, usize) {
-    let max_col = columns.iter().copied().max().unwrap_or(0);
-    let mut col_map = vec![usize::MAX; max_col + 1];
-    for (proj_idx, &orig_col) in columns.iter().enumerate() {
-        col_map[orig_col] = proj_idx;
+/// Result of a decode call whose scratch buffer could not grow.
+fn decode_failed(out_bytes_consumed: *mut usize) -> usize {
+    if !out_bytes_consumed.is_null() {
+        unsafe { *out_bytes_consumed = 0 };
+    }
+    0
+}
+
+/// Receives the cells the structural walk finds.
+trait CellSink {
+    /// Row `row` begins; its cells are empty until `cell` says otherwise.
+    fn start_row(&mut self, row: usize);
+    /// Non-empty cell `bytes` (still escaped, if `escaped`) of projected
+    /// column `proj`, at `offset` in the input. False if the scratch buffer
+    /// could not grow.
+    fn cell(&mut self, row: usize, proj: usize, bytes: &[u8], offset: usize, escaped: bool)
+        -> bool;
+}
+
+/// Walk up to `max_rows` rows of `input`, handing the projected cells to
+/// `sink`. An empty line ends a row only if the row had cells; trailing
+/// cells without a final blank line still form a row. Returns the rows
+/// found and the bytes they span, or None if the sink failed.
+fn walk_rows<S: CellSink>(
+    input: &[u8],
+    col_map: &[usize],
+    max_col: usize,
+    max_rows: usize,
+    sink: &mut S,
+) -> Option<(usize, usize)> {
+    walk_rows_with(block_masks(), input, col_map, max_col, max_rows, sink)
+}
+
+/// `walk_rows` with the stage-one kernel `kernel`.
+fn walk_rows_with<S: CellSink>(
+    kernel: BlockMasks,
+    input: &[u8],
+    col_map: &[usize],
+    max_col: usize,
+    max_rows: usize,
+    sink: &mut S,
+) -> Option<(usize, usize)> {
+    let len = input.len();
+    let mut structure = Structure::new(input, kernel);
+    let mut row_count: usize = 0;
+    let mut col_idx: usize = 0;
+    let mut start: usize = 0;
+    let mut row_has_cells = false;
+    let mut bytes_consumed: usize = 0;
+    // Row end found by skip_to_row_end, handled as the next newline.
+    let mut row_end = None;
+
+    sink.start_row(0);
+    while let Some(pos) = row_end.take().or_else(|| structure.next_newline()) {
+        if pos > start {
+            // Non-empty cell
+            if col_idx <= max_col && col_map[col_idx] != usize::MAX {
+                let escaped = structure.has_backslash(start, pos);
+                let cell = &input[start..pos];
+                if !sink.cell(row_count, col_map[col_idx], cell, start, escaped) {
+                    return None;
+                }
+            }
+            col_idx += 1;
+            row_has_cells = true;
+            if col_idx > max_col {
+                // Past the last projected column: jump to the empty line
+                // that ends the row.
+                match structure.skip_to_row_end() {
+                    Some(end) => {
+                        start = end;
+                        row_end = Some(end);
+                        continue;
+                    }
+                    None => {
+                        start = len;
+                        break;
+                    }
+                }
+            }
+        } else {
+            // Empty cell = row boundary (\n\n)
+            if row_has_cells {
+                row_count += 1;
+                bytes_consumed = pos + 1;
+                if row_count >= max_rows {
+                    break;
+                }
+                sink.start_row(row_count);
+            }
+            col_idx = 0;
+            row_has_cells = false;
+        }
+        start = pos + 1;
+    }
+
+    // Handle trailing data (no final \n\n).
+    if row_count < max_rows && start < len {
+        if col_idx <= max_col && col_map[col_idx] != usize::MAX {
+            let escaped = input[start..].contains(&b'\\');
+            if !sink.cell(row_count, col_map[col_idx], &input[start..], start, escaped) {
+                return None;
+            }
+        }
+        row_has_cells = true;
+    }
+
+    if row_count < max_rows && row_has_cells {
+        row_count += 1;
+        bytes_consumed = len;
+    }
+    Some((row_count, bytes_consumed))
+}
+
+/// `nsv_decode_flat`: cell locations into row-major offset/length arrays.
+struct FlatSink<'a> {
+    offsets: &'a mut [usize],
+    lengths: &'a mut [usize],
+    num_cols: usize,
+    unescape_flags: &'a [u8],
+    input_base_offset: usize,
+    scratch: &'a mut ScratchBytes,
+}
+
+impl CellSink for FlatSink<'_> {
+    fn start_row(&mut self, row: usize) {
+        let base = row * self.num_cols;
+        self.offsets[base..base + self.num_cols].fill(0);
+        self.lengths[base..base + self.num_cols].fill(0);
+    }
+
+    fn cell(&mut self, row: usize, proj: usize, bytes: &[u8], offset: usize, escaped: bool)
+        -> bool {
+        let base = row * self.num_cols + proj;
+        if escaped && self.unescape_flags[proj] != 0 {
+            let scratch_start = self.scratch.len();
+            let Some(unescaped_len) = self.scratch.extend_unescaped(bytes) else {
+                return false;
+            };
+            self.offsets[base] = scratch_start | SCRATCH_BIT;
+            self.lengths[base] = unescaped_len;
+            return true;
+        }
+        self.offsets[base] = self.input_base_offset + offset;
+        self.lengths[base] = bytes.len();
+        true
     }
-    (col_map, max_col)
 }
 
 /// Decode a chunk of NSV into caller-provided flat arrays.
@@ -136,10 +861,11 @@ fn build_col_map(columns: &[usize]) -> (Vec<usize>, usize) {
 /// - `needs_unescape`: per-projected-column flag (1 = VARCHAR, do unescape)
 /// - `out_offsets`, `out_lengths`: flat arrays of size `max_rows * num_cols`
 /// - `max_rows`: capacity of the output arrays
-/// - `out_scratch`: receives a scratch buffer handle (caller frees)
+/// - `scratch`: unescaped cells are appended here (see `nsv_scratch_new`)
 /// - `out_bytes_consumed`: receives bytes consumed from input
 ///
-/// Returns the number of rows decoded (<= max_rows).
+/// Returns the number of rows decoded (<= max_rows), or 0 with nothing
+/// consumed if the scratch buffer could not grow.
 #[no_mangle]
 pub extern "C" fn nsv_decode_flat(
     ptr: *const u8,
@@ -151,10 +877,11 @@ pub extern "C" fn nsv_decode_flat(
     out_offsets: *mut usize,
     out_lengths: *mut usize,
     max_rows: usize,
-    out_scratch: *mut *mut NsvScratchBuf,
+    scratch: *mut NsvScratchBuf,
     out_bytes_consumed: *mut usize,
 ) -> usize {
     if ptr.is_null()
+        || scratch.is_null()
         || col_indices.is_null()
         || needs_unescape.is_null()
         || out_offsets.is_null()
@@ -167,124 +894,332 @@ pub extern "C" fn nsv_decode_flat(
 
     let input = unsafe { std::slice::from_raw_parts(ptr, len) };
     let columns = unsafe { std::slice::from_raw_parts(col_indices, num_cols) };
-    let unescape_flags = unsafe { std::slice::from_raw_parts(needs_unescape, num_cols) };
-    let offsets = unsafe { std::slice::from_raw_parts_mut(out_offsets, max_rows * num_cols) };
-    let lengths = unsafe { std::slice::from_raw_parts_mut(out_lengths, max_rows * num_cols) };
+    let scratch = unsafe { &mut *scratch };
+    let (col_map, max_col) = scratch.columns.get(columns);
+    let mut sink = FlatSink {
+        offsets: unsafe { std::slice::from_raw_parts_mut(out_offsets, max_rows * num_cols) },
+        lengths: unsafe { std::slice::from_raw_parts_mut(out_lengths, max_rows * num_cols) },
+        num_cols,
+        unescape_flags: unsafe { std::slice::from_raw_parts(needs_unescape, num_cols) },
+        input_base_offset,
+        scratch: &mut scratch.bytes,
+    };
+    let Some((rows, bytes_consumed)) = walk_rows(input, col_map, max_col, max_rows, &mut sink)
+    else {
+        return decode_failed(out_bytes_consumed);
+    };
+    if !out_bytes_consumed.is_null() {
+        unsafe { *out_bytes_consumed = bytes_consumed };
+    }
+    rows
+}
 
-    let (col_map, max_col) = build_col_map(columns);
+// ── Column decode (straight into DuckDB vectors) ───────────────────
+//
+// Writes each projected column into the caller's vector memory: DuckDB
+// `string_t`s, or parsed BIGINT / DOUBLE / BOOLEAN values, plus validity
+// bits. Nothing is written to intermediate arrays.
 
-    let mut scratch = Vec::with_capacity(4096);
-    let mut row_count: usize = 0;
-    let mut col_idx: usize = 0;
-    let mut start: usize = 0;
-    let mut row_has_cells = false;
-    let mut bytes_consumed: usize = 0;
+pub const NSV_DEST_VARCHAR: u32 = 0;
+pub const NSV_DEST_BIGINT: u32 = 1;
+pub const NSV_DEST_DOUBLE: u32 = 2;
+pub const NSV_DEST_BOOLEAN: u32 = 3;
 
-    // Zero-initialize first row.
-    for c in 0..num_cols {
-        offsets[c] = 0;
-        lengths[c] = 0;
-    }
-
-    for pos in 0..len {
-        if input[pos] == b'\n' {
-            if pos > start {
-                // Non-empty cell
-                if col_idx <= max_col && row_count < max_rows {
-                    if let Some(&proj_idx) = col_map.get(col_idx) {
-                        if proj_idx != usize::MAX {
-                            let base = row_count * num_cols + proj_idx;
-                            if unescape_flags[proj_idx] != 0 {
-                                match nsv::unescape_bytes(&input[start..pos]) {
-                                    std::borrow::Cow::Borrowed(_) => {
-                                        offsets[base] = input_base_offset + start;
-                                        lengths[base] = pos - start;
-                                    }
-                                    std::borrow::Cow::Owned(unescaped) => {
-                                        let scratch_start = scratch.len();
-                                        let ulen = unescaped.len();
-                                        scratch.extend_from_slice(&unescaped);
-                                        offsets[base] = scratch_start | SCRATCH_BIT;
-                                        lengths[base] = ulen;
-                                    }
-                                }
-                            } else {
-                                offsets[base] = input_base_offset + start;
-                                lengths[base] = pos - start;
-                            }
-                        }
-                    }
-                }
-                col_idx += 1;
-                row_has_cells = true;
+/// Where one projected column goes. Mirrors `NsvColumnDest` in nsv_ffi.h.
+#[repr(C)]
+pub struct NsvColumnDest {
+    /// One of the `NSV_DEST_*` kinds.
+    pub kind: u32,
+    /// VARCHAR: unescape cells (otherwise their raw bytes are kept).
+    pub unescape: u32,
+    /// `string_t`, `int64_t`, `double` or `bool` array of `max_rows`.
+    pub data: *mut c_void,
+    /// Zeroed by the caller; bit r is set when row r is not NULL.
+    pub validity: *mut u64,
+    /// Typed kinds: `string_t` array receiving the raw text of cells that
+    /// did not parse, for the caller to cast.
+    pub fallback: *mut c_void,
+    /// Zeroed by the caller; bit r is set for those cells.
+    pub fallback_mask: *mut u64,
+}
+
+/// DuckDB's `string_t`: length, then either up to 12 inlined bytes or a
+/// 4-byte prefix and a pointer.
+const STRING_INLINE_LENGTH: usize = 12;
+
+/// A string of the current call that lives in scratch; pointed at it once
+/// scratch stops moving.
+struct ScratchFixup {
+    dest: *mut u8,
+    offset: usize,
+}
+
+#[inline(always)]
+fn set_bit(words: *mut u64, row: usize) {
+    unsafe { *words.add(row / 64) |= 1u64 << (row % 64) };
+}
+
+/// Write `bytes` as a `string_t` at `dest`; non-inlined strings point at
+/// `data` (which holds `bytes`).
+#[inline(always)]
+fn write_string(dest: *mut u8, bytes: &[u8], data: *const u8) {
+    let mut value = [0u8; 16];
+    value[..4].copy_from_slice(&(bytes.len() as u32).to_le_bytes());
+    if bytes.len() <= STRING_INLINE_LENGTH {
+        value[4..4 + bytes.len()].copy_from_slice(bytes);
+    } else {
+        value[4..8].copy_from_slice(&bytes[..4]);
+        value[8..].copy_from_slice(&(data as usize).to_ne_bytes()[..8]);
+    }
+    unsafe { std::ptr::copy_nonoverlapping(value.as_ptr(), dest, 16) };
+}
+
+/// Plain integers only (`-?[0-9]+`); anything else is left to the caller's
+/// cast so the accepted syntax stays DuckDB's.
+fn parse_bigint(bytes: &[u8]) -> Option<i64> {
+    let digits = bytes.strip_prefix(b"-").unwrap_or(bytes);
+    if digits.is_empty() || digits.len() > 19 || !digits.iter().all(u8::is_ascii_digit) {
+        return None;
+    }
+    std::str::from_utf8(bytes).ok()?.parse().ok()
+}
+
+fn parse_double(bytes: &[u8]) -> Option<f64> {
+    if !bytes
+        .iter()
+        .all(|&b| b.is_ascii_digit() || matches!(b, b'.' | b'-' | b'+' | b'e' | b'E'))
+    {
+        return None;
+    }
+    let value: f64 = std::str::from_utf8(bytes).ok()?.parse().ok()?;
+    value.is_finite().then_some(value)
+}
+
+fn parse_boolean(bytes: &[u8]) -> Option<bool> {
+    match bytes {
+        b"true" => Some(true),
+        b"false" => Some(false),
+        _ => None,
+    }
+}
+
+struct ColumnSink<'a> {
+    dests: &'a [NsvColumnDest],
+    input: *const u8,
+    scratch: &'a mut ScratchBytes,
+    fixups: &'a mut Vec<ScratchFixup>,
+    large: &'a mut Vec<(usize, ScratchBytes)>,
+}
+
+impl ColumnSink<'_> {
+    fn string(
+        &mut self,
+        dest: &NsvColumnDest,
+        row: usize,
+        proj: usize,
+        bytes: &[u8],
+        offset: usize,
+        escaped: bool,
+    ) -> bool {
+        let out = unsafe { (dest.data as *mut u8).add(row * 16) };
+        if escaped && dest.unescape != 0 {
+            if bytes.len() >= LARGE_CELL_BYTES {
+                return self.large_string(dest, row, proj, bytes);
+            }
+            let scratch_start = self.scratch.len();
+            let Some(unescaped_len) = self.scratch.extend_unescaped(bytes) else {
+                return false;
+            };
+            let unescaped = unsafe {
+                std::slice::from_raw_parts(self.scratch.ptr.add(scratch_start), unescaped_len)
+            };
+            if unescaped_len > STRING_INLINE_LENGTH {
+                self.fixups.push(ScratchFixup {
+                    dest: out,
+                    offset: scratch_start,
+                });
             } else {
-                // Empty cell = row boundary (\n\n)
-                if row_has_cells {
-                    row_count += 1;
-                    bytes_consumed = pos + 1;
-                    if row_count >= max_rows {
-                        break;
-                    }
-                    // Zero-initialize next row.
-                    let base = row_count * num_cols;
-                    for c in 0..num_cols {
-                        offsets[base + c] = 0;
-                        lengths[base + c] = 0;
-                    }
-                }
-                col_idx = 0;
-                row_has_cells = false;
+                self.scratch.len = scratch_start;
             }
-            start = pos + 1;
+            if unescaped_len > 0 {
+                write_string(out, unescaped, std::ptr::null());
+                set_bit(dest.validity, row);
+            }
+            return true;
         }
+        write_string(out, bytes, unsafe { self.input.add(offset) });
+        set_bit(dest.validity, row);
+        true
     }
 
-    // Handle trailing data (no final \n\n).
-    if row_count < max_rows && start < len {
-        if col_idx <= max_col {
-            if let Some(&proj_idx) = col_map.get(col_idx) {
-                if proj_idx != usize::MAX {
-                    let base = row_count * num_cols + proj_idx;
-                    if unescape_flags[proj_idx] != 0 {
-                        match nsv::unescape_bytes(&input[start..]) {
-                            std::borrow::Cow::Borrowed(_) => {
-                                offsets[base] = input_base_offset + start;
-                                lengths[base] = len - start;
-                            }
-                            std::borrow::Cow::Owned(unescaped) => {
-                                let scratch_start = scratch.len();
-                                let ulen = unescaped.len();
-                                scratch.extend_from_slice(&unescaped);
-                                offsets[base] = scratch_start | SCRATCH_BIT;
-                                lengths[base] = ulen;
-                            }
-                        }
-                    } else {
-                        offsets[base] = input_base_offset + start;
-                        lengths[base] = len - start;
-                    }
-                }
-            }
+    /// Unescape a large cell once, into an allocation the column's vector
+    /// takes over whole.
+    fn large_string(&mut self, dest: &NsvColumnDest, row: usize, proj: usize, bytes: &[u8])
+        -> bool {
+        let mut cell = ScratchBytes::new(self.scratch.allocator);
+        let Some(unescaped_len) = cell.extend_unescaped(bytes) else {
+            return false;
+        };
+        let unescaped = unsafe { std::slice::from_raw_parts(cell.ptr, unescaped_len) };
+        let out = unsafe { (dest.data as *mut u8).add(row * 16) };
+        if unescaped_len > 0 {
+            write_string(out, unescaped, cell.ptr);
+            set_bit(dest.validity, row);
         }
-        row_has_cells = true;
+        if unescaped_len > STRING_INLINE_LENGTH {
+            self.large.push((proj, cell));
+        }
+        true
     }
+}
 
-    if row_count < max_rows && row_has_cells {
-        row_count += 1;
-        bytes_consumed = len;
+impl CellSink for ColumnSink<'_> {
+    fn start_row(&mut self, _row: usize) {
+        // Validity starts all NULL; only cells that are found are set.
+    }
+
+    fn cell(&mut self, row: usize, proj: usize, bytes: &[u8], offset: usize, escaped: bool)
+        -> bool {
+        let dest = &self.dests[proj];
+        let parsed = match dest.kind {
+            NSV_DEST_BIGINT => parse_bigint(bytes)
+                .map(|v| unsafe { *(dest.data as *mut i64).add(row) = v })
+                .is_some(),
+            NSV_DEST_DOUBLE => parse_double(bytes)
+                .map(|v| unsafe { *(dest.data as *mut f64).add(row) = v })
+                .is_some(),
+            NSV_DEST_BOOLEAN => parse_boolean(bytes)
+                .map(|v| unsafe { *(dest.data as *mut bool).add(row) = v })
+                .is_some(),
+            _ => return self.string(dest, row, proj, bytes, offset, escaped),
+        };
+        if parsed {
+            set_bit(dest.validity, row);
+        } else {
+            let out = unsafe { (dest.fallback as *mut u8).add(row * 16) };
+            write_string(out, bytes, unsafe { self.input.add(offset) });
+            set_bit(dest.fallback_mask, row);
+        }
+        true
+    }
+}
+
+/// Decode up to `max_rows` rows of `ptr[..len]` straight into the column
+/// destinations `dests` (one per projected column in `col_indices`).
+/// Non-inlined strings point into the input, or into `scratch` for cells
+/// that were unescaped (large ones into allocations of their own); both
+/// must outlive the strings.
+///
+/// Returns the number of rows decoded, or 0 with nothing consumed if the
+/// scratch buffer could not grow.
+#[no_mangle]
+pub extern "C" fn nsv_decode_columns(
+    ptr: *const u8,
+    len: usize,
+    col_indices: *const usize,
+    num_cols: usize,
+    dests: *const NsvColumnDest,
+    max_rows: usize,
+    scratch: *mut NsvScratchBuf,
+    out_bytes_consumed: *mut usize,
+) -> usize {
+    if ptr.is_null()
+        || scratch.is_null()
+        || col_indices.is_null()
+        || dests.is_null()
+        || num_cols == 0
+        || max_rows == 0
+    {
+        return 0;
+    }
+
+    let input = unsafe { std::slice::from_raw_parts(ptr, len) };
+    let columns = unsafe { std::slice::from_raw_parts(col_indices, num_cols) };
+    let scratch = unsafe { &mut *scratch };
+    let (col_map, max_col) = scratch.columns.get(columns);
+    scratch.fixups.clear();
+    let mut sink = ColumnSink {
+        dests: unsafe { std::slice::from_raw_parts(dests, num_cols) },
+        input: ptr,
+        scratch: &mut scratch.bytes,
+        fixups: &mut scratch.fixups,
+        large: &mut scratch.large,
+    };
+    let Some((rows, bytes_consumed)) = walk_rows(input, col_map, max_col, max_rows, &mut sink)
+    else {
+        return decode_failed(out_bytes_consumed);
+    };
+    // Scratch has stopped growing; point its strings at it.
+    for fixup in scratch.fixups.iter() {
+        let data = unsafe { scratch.bytes.ptr.add(fixup.offset) } as usize;
+        unsafe {
+            std::ptr::copy_nonoverlapping(data.to_ne_bytes().as_ptr(), fixup.dest.add(8), 8)
+        };
+    }
+    if !out_bytes_consumed.is_null() {
+        unsafe { *out_bytes_consumed = bytes_consumed };
+    }
+    rows
+}
+
+// ── Row counting (COUNT(*) without decoding) ───────────────────────
+
+/// Count the rows in `input` with `nsv_decode_flat`'s rules, without
+/// looking at cells.
+///
+/// A row ends at the second `\n` of every run of two or more newlines that
+/// follows a non-newline byte (an empty line only ends a row that had
+/// cells). Trailing cells without a final blank line form one more row.
+fn count_rows(input: &[u8]) -> usize {
+    count_rows_with(block_masks(), input)
+}
+
+/// `count_rows` with the stage-one kernel `kernel`.
+fn count_rows_with(kernel: BlockMasks, input: &[u8]) -> usize {
+    let mut rows = 0usize;
+    // Newline mask of the bytes before the current block; the start of the
+    // input behaves as if preceded by newlines.
+    let mut prev = u64::MAX;
+    let mut newlines = [0u64; INDEX_BLOCKS];
+    let mut backslashes = [0u64; INDEX_BLOCKS];
+    let full = input.len() / 64 * 64;
+    for window in input[..full].chunks(64 * INDEX_BLOCKS) {
+        let blocks = window.len() / 64;
+        kernel(window, &mut newlines[..blocks], &mut backslashes[..blocks]);
+        for &m in &newlines[..blocks] {
+            let m1 = (m << 1) | (prev >> 63);
+            let m2 = (m << 2) | (prev >> 62);
+            rows += (m & m1 & !m2).count_ones() as usize;
+            prev = m;
+        }
     }
-
-    if !out_bytes_consumed.is_null() {
-        unsafe { *out_bytes_consumed = bytes_consumed };
+    let tail = &input[full..];
+    if !tail.is_empty() {
+        let mut block = [0u8; 64];
+        block[..tail.len()].copy_from_slice(tail);
+        let m = byte_mask(&block, b'\n');
+        let m1 = (m << 1) | (prev >> 63);
+        let m2 = (m << 2) | (prev >> 62);
+        rows += (m & m1 & !m2).count_ones() as usize;
     }
 
-    if !out_scratch.is_null() {
-        unsafe {
-            *out_scratch = Box::into_raw(Box::new(NsvScratchBuf { data: scratch }));
+    // Trailing row: cells after the last row boundary.
+    if let Some(last) = input.iter().rposition(|&b| b != b'\n') {
+        if input.len() - last - 1 < 2 {
+            rows += 1;
         }
     }
+    rows
+}
 
-    row_count
+/// Count the rows in a chunk of NSV (a range within the file buffer), with
+/// the same row rules as `nsv_decode_flat` but without decoding any cell.
+#[no_mangle]
+pub extern "C" fn nsv_count_rows(ptr: *const u8, len: usize) -> usize {
+    if ptr.is_null() || len == 0 {
+        return 0;
+    }
+    count_rows(unsafe { std::slice::from_raw_parts(ptr, len) })
 }
 
 // ── Encoding (COPY TO) ─────────────────────────────────────────────
@@ -425,6 +1360,189 @@ pub extern "C" fn nsv_write_chunk(
     }
 }
 
+// ── Compression ─────────────────────────────────────────────────────
+//
+// The gzip and zstd codecs are the ones DuckDB bundles (see
+// nsv_compress.cpp); only the framing of compressed files lives here.
+
+const COMPRESSION_NONE: i32 = 0;
+const COMPRESSION_GZIP: i32 = 1;
+const COMPRESSION_ZSTD: i32 = 2;
+
+fn into_raw_buf(buf: Vec<u8>, out_ptr: *mut *mut u8, out_len: *mut usize) {
+    let len = buf.len();
+    let ptr = Box::into_raw(buf.into_boxed_slice()) as *mut u8;
+    unsafe {
+        *out_ptr = ptr;
+        *out_len = len;
+    }
+}
+
+/// Detect the compression of a buffer from its magic bytes.
+#[no_mangle]
+pub extern "C" fn nsv_detect_compression(ptr: *const u8, len: usize) -> i32 {
+    if ptr.is_null() || len < 4 {
+        return COMPRESSION_NONE;
+    }
+    let input = unsafe { std::slice::from_raw_parts(ptr, 4) };
+    if input[0] == 0x1f && input[1] == 0x8b {
+        return COMPRESSION_GZIP;
+    }
+    let magic = u32::from_le_bytes([input[0], input[1], input[2], input[3]]);
+    // Regular frame, or a skippable frame (0x184D2A50..=0x184D2A5F).
+    if magic == 0xFD2F_B528 || magic & 0xFFFF_FFF0 == 0x184D_2A50 {
+        return COMPRESSION_ZSTD;
+    }
+    COMPRESSION_NONE
+}
+
+// ── Seekable zstd ───────────────────────────────────────────────────
+//
+// Files written with COMPRESSION zstd end in the standard zstd seekable-format
+// seek table, preceded by a small skippable "row marker" frame that promises
+// every frame ends on an NSV row boundary. Only files carrying the marker are
+// scanned frame-by-frame; other seekable files are inflated as a whole.
+//
+//   [frame 0] .. [frame n-1] [row marker] [seek table]
+//
+// The marker is listed in the seek table (decompressed size 0) so generic
+// seekable readers still see a consistent table.
+
+const SKIPPABLE_MAGIC_ROW_MARKER: u32 = 0x184D_2A50;
+const SKIPPABLE_MAGIC_SEEK_TABLE: u32 = 0x184D_2A5E;
+const SEEKABLE_MAGIC: u32 = 0x8F92_EAB1;
+const ROW_MARKER_PAYLOAD: &[u8; 8] = b"NSVROWS1";
+const ROW_MARKER_SIZE: usize = 8 + ROW_MARKER_PAYLOAD.len();
+const SEEK_FOOTER_SIZE: usize = 9;
+
+fn read_u32(buf: &[u8], pos: usize) -> u32 {
+    u32::from_le_bytes([buf[pos], buf[pos + 1], buf[pos + 2], buf[pos + 3]])
+}
+
+/// Build the trailer (row marker + seek table) for `n` frames already written.
+/// Returns 0 on success, -1 if a frame does not fit the 32-bit table fields.
+#[no_mangle]
+pub extern "C" fn nsv_zstd_seek_table(
+    comp_sizes: *const usize,
+    decomp_sizes: *const usize,
+    n: usize,
+    out_ptr: *mut *mut u8,
+    out_len: *mut usize,
+) -> i32 {
+    if (n > 0 && (comp_sizes.is_null() || decomp_sizes.is_null()))
+        || out_ptr.is_null()
+        || out_len.is_null()
+    {
+        return -1;
+    }
+    let (comp, decomp) = if n == 0 {
+        (&[][..], &[][..])
+    } else {
+        unsafe {
+            (
+                std::slice::from_raw_parts(comp_sizes, n),
+                std::slice::from_raw_parts(decomp_sizes, n),
+            )
+        }
+    };
+    let num_entries = n + 1;
+    if comp
+        .iter()
+        .chain(decomp)
+        .any(|&size| size > u32::MAX as usize)
+        || num_entries > u32::MAX as usize
+    {
+        return -1;
+    }
+
+    let table_size = num_entries * 8 + SEEK_FOOTER_SIZE;
+    let mut buf = Vec::with_capacity(ROW_MARKER_SIZE + 8 + table_size);
+    buf.extend_from_slice(&SKIPPABLE_MAGIC_ROW_MARKER.to_le_bytes());
+    buf.extend_from_slice(&(ROW_MARKER_PAYLOAD.len() as u32).to_le_bytes());
+    buf.extend_from_slice(ROW_MARKER_PAYLOAD);
+
+    buf.extend_from_slice(&SKIPPABLE_MAGIC_SEEK_TABLE.to_le_bytes());
+    buf.extend_from_slice(&(table_size as u32).to_le_bytes());
+    for (&c, &d) in comp.iter().zip(decomp) {
+        buf.extend_from_slice(&(c as u32).to_le_bytes());
+        buf.extend_from_slice(&(d as u32).to_le_bytes());
+    }
+    buf.extend_from_slice(&(ROW_MARKER_SIZE as u32).to_le_bytes());
+    buf.extend_from_slice(&0u32.to_le_bytes());
+    buf.extend_from_slice(&(num_entries as u32).to_le_bytes());
+    buf.push(0); // descriptor: no checksums
+    buf.extend_from_slice(&SEEKABLE_MAGIC.to_le_bytes());
+
+    into_raw_buf(buf, out_ptr, out_len);
+    0
+}
+
+/// If `ptr` holds a row-aligned seekable zstd NSV file, return its number of
+/// data frames (0 otherwise). Frame sizes are written to the output arrays
+/// when they are non-null and can hold all frames.
+#[no_mangle]
+pub extern "C" fn nsv_zstd_seekable_frames(
+    ptr: *const u8,
+    len: usize,
+    out_comp_sizes: *mut usize,
+    out_decomp_sizes: *mut usize,
+    cap: usize,
+) -> usize {
+    if ptr.is_null() || len < 8 + SEEK_FOOTER_SIZE {
+        return 0;
+    }
+    let input = unsafe { std::slice::from_raw_parts(ptr, len) };
+
+    let footer = len - SEEK_FOOTER_SIZE;
+    if read_u32(input, footer + 5) != SEEKABLE_MAGIC {
+        return 0;
+    }
+    let num_entries = read_u32(input, footer) as usize;
+    let descriptor = input[footer + 4];
+    let entry_size = if descriptor & 0x80 != 0 { 12 } else { 8 };
+    let table_size = match num_entries.checked_mul(entry_size) {
+        Some(size) => size + SEEK_FOOTER_SIZE,
+        None => return 0,
+    };
+    if num_entries == 0 || table_size + 8 > len {
+        return 0;
+    }
+    let table_start = len - table_size;
+    let frame_start = table_start - 8;
+    if read_u32(input, frame_start) != SKIPPABLE_MAGIC_SEEK_TABLE
+        || read_u32(input, frame_start + 4) as usize != table_size
+    {
+        return 0;
+    }
+
+    // The frames must tile the file exactly, ending in the row marker.
+    let mut comp_total = 0usize;
+    for e in 0..num_entries {
+        comp_total += read_u32(input, table_start + e * entry_size) as usize;
+    }
+    if comp_total != frame_start || frame_start < ROW_MARKER_SIZE {
+        return 0;
+    }
+    let marker = frame_start - ROW_MARKER_SIZE;
+    if read_u32(input, marker) != SKIPPABLE_MAGIC_ROW_MARKER
+        || &input[marker + 8..frame_start] != ROW_MARKER_PAYLOAD
+    {
+        return 0;
+    }
+
+    let num_frames = num_entries - 1;
+    if !out_comp_sizes.is_null() && !out_decomp_sizes.is_null() && cap >= num_frames {
+        let comp = unsafe { std::slice::from_raw_parts_mut(out_comp_sizes, num_frames) };
+        let decomp = unsafe { std::slice::from_raw_parts_mut(out_decomp_sizes, num_frames) };
+        for f in 0..num_frames {
+            let entry = table_start + f * entry_size;
+            comp[f] = read_u32(input, entry) as usize;
+            decomp[f] = read_u32(input, entry + 4) as usize;
+        }
+    }
+    num_frames
+}
+
 /// Free a buffer returned by `nsv_encoder_finish` or `nsv_write_chunk`.
 #[no_mangle]
 pub extern "C" fn nsv_free_buf(ptr: *mut u8, len: usize) {
@@ -488,7 +1606,7 @@ mod tests {
         let max_rows = 10;
         let mut offsets = vec![0usize; max_rows * 2];
         let mut lengths = vec![0usize; max_rows * 2];
-        let mut scratch: *mut NsvScratchBuf = std::ptr::null_mut();
+        let scratch = nsv_scratch_new(std::ptr::null());
         let mut consumed: usize = 0;
 
         let rows = nsv_decode_flat(
@@ -501,7 +1619,7 @@ mod tests {
             offsets.as_mut_ptr(),
             lengths.as_mut_ptr(),
             max_rows,
-            &mut scratch,
+            scratch,
             &mut consumed,
         );
 
@@ -512,9 +1630,7 @@ mod tests {
         assert_eq!(lengths[2], 5); // "Alice"
         assert_eq!(lengths[3], 2); // "30"
 
-        if !scratch.is_null() {
-            nsv_scratch_free(scratch);
-        }
+        nsv_scratch_free(scratch);
     }
 
     #[test]
@@ -525,7 +1641,7 @@ mod tests {
         let max_rows = 2;
         let mut offsets = vec![0usize; max_rows];
         let mut lengths = vec![0usize; max_rows];
-        let mut scratch: *mut NsvScratchBuf = std::ptr::null_mut();
+        let scratch = nsv_scratch_new(std::ptr::null());
         let mut consumed: usize = 0;
 
         let rows = nsv_decode_flat(
@@ -538,14 +1654,11 @@ mod tests {
             offsets.as_mut_ptr(),
             lengths.as_mut_ptr(),
             max_rows,
-            &mut scratch,
+            scratch,
             &mut consumed,
         );
         assert_eq!(rows, 2);
-        if !scratch.is_null() {
-            nsv_scratch_free(scratch);
-            scratch = std::ptr::null_mut();
-        }
+        nsv_scratch_reset(scratch);
 
         // Resume from consumed offset
         let rows2 = nsv_decode_flat(
@@ -558,13 +1671,11 @@ mod tests {
             offsets.as_mut_ptr(),
             lengths.as_mut_ptr(),
             max_rows,
-            &mut scratch,
+            scratch,
             &mut consumed,
         );
         assert_eq!(rows2, 2);
-        if !scratch.is_null() {
-            nsv_scratch_free(scratch);
-        }
+        nsv_scratch_free(scratch);
     }
 
     #[test]
@@ -575,7 +1686,7 @@ mod tests {
         let max_rows = 10;
         let mut offsets = vec![0usize; max_rows];
         let mut lengths = vec![0usize; max_rows];
-        let mut scratch: *mut NsvScratchBuf = std::ptr::null_mut();
+        let scratch = nsv_scratch_new(std::ptr::null());
         let mut consumed: usize = 0;
 
         let rows = nsv_decode_flat(
@@ -588,19 +1699,574 @@ mod tests {
             offsets.as_mut_ptr(),
             lengths.as_mut_ptr(),
             max_rows,
-            &mut scratch,
+            scratch,
             &mut consumed,
         );
         assert_eq!(rows, 1);
         assert!(offsets[0] & SCRATCH_BIT != 0, "should use scratch buffer");
         assert_eq!(lengths[0], 11); // "line1\nline2"
 
-        if !scratch.is_null() {
-            let scratch_data = nsv_scratch_ptr(scratch);
+        let scratch_data = nsv_scratch_ptr(scratch);
+        let off = offsets[0] & !SCRATCH_BIT;
+        let s = unsafe { std::slice::from_raw_parts(scratch_data.add(off), lengths[0]) };
+        assert_eq!(s, b"line1\nline2");
+        nsv_scratch_free(scratch);
+    }
+
+    extern "C" fn counting_alloc(ctx: *mut c_void, size: usize) -> *mut u8 {
+        unsafe { *(ctx as *mut isize) += size as isize };
+        unsafe { std::alloc::alloc(Layout::array::<u8>(size).unwrap()) }
+    }
+
+    extern "C" fn counting_realloc(
+        ctx: *mut c_void,
+        ptr: *mut u8,
+        old_size: usize,
+        new_size: usize,
+    ) -> *mut u8 {
+        unsafe { *(ctx as *mut isize) += new_size as isize - old_size as isize };
+        unsafe { std::alloc::realloc(ptr, Layout::array::<u8>(old_size).unwrap(), new_size) }
+    }
+
+    extern "C" fn counting_free(ctx: *mut c_void, ptr: *mut u8, size: usize) {
+        unsafe { *(ctx as *mut isize) -= size as isize };
+        unsafe { std::alloc::dealloc(ptr, Layout::array::<u8>(size).unwrap()) }
+    }
+
+    extern "C" fn failing_alloc(_ctx: *mut c_void, _size: usize) -> *mut u8 {
+        std::ptr::null_mut()
+    }
+
+    /// Decode one VARCHAR column of `input` with `allocator`.
+    fn decode_with(input: &[u8], allocator: &NsvAllocator) -> (usize, usize, Vec<u8>) {
+        let cols: [usize; 1] = [0];
+        let needs_unescape: [u8; 1] = [1];
+        let max_rows = 10;
+        let mut offsets = vec![0usize; max_rows];
+        let mut lengths = vec![0usize; max_rows];
+        let scratch = nsv_scratch_new(allocator);
+        let mut consumed: usize = 0;
+        let rows = nsv_decode_flat(
+            input.as_ptr(),
+            input.len(),
+            0,
+            cols.as_ptr(),
+            1,
+            needs_unescape.as_ptr(),
+            offsets.as_mut_ptr(),
+            lengths.as_mut_ptr(),
+            max_rows,
+            scratch,
+            &mut consumed,
+        );
+        let mut cell = Vec::new();
+        if rows > 0 && offsets[0] & SCRATCH_BIT != 0 {
             let off = offsets[0] & !SCRATCH_BIT;
-            let s = unsafe { std::slice::from_raw_parts(scratch_data.add(off), lengths[0]) };
-            assert_eq!(s, b"line1\nline2");
-            nsv_scratch_free(scratch);
+            let data = nsv_scratch_ptr(scratch);
+            cell.extend_from_slice(unsafe { std::slice::from_raw_parts(data.add(off), lengths[0]) });
+        }
+        nsv_scratch_free(scratch);
+        (rows, consumed, cell)
+    }
+
+    #[test]
+    fn test_flat_decode_allocator() {
+        let mut outstanding: isize = 0;
+        let allocator = NsvAllocator {
+            ctx: &mut outstanding as *mut isize as *mut c_void,
+            alloc: counting_alloc,
+            realloc: counting_realloc,
+            free: counting_free,
+        };
+        // Long enough to grow the scratch buffer past its first allocation.
+        let big = "a\\n".repeat(3000);
+        let input = format!("{}\n\nx\n\n", big);
+        let (rows, consumed, cell) = decode_with(input.as_bytes(), &allocator);
+        assert_eq!(rows, 2);
+        assert_eq!(consumed, input.len());
+        assert_eq!(cell, "a\n".repeat(3000).into_bytes());
+        assert_eq!(outstanding, 0, "scratch must be freed through the allocator");
+
+        let failing = NsvAllocator {
+            alloc: failing_alloc,
+            ..allocator
+        };
+        let (rows, consumed, _) = decode_with(input.as_bytes(), &failing);
+        assert_eq!((rows, consumed), (0, 0));
+        // No escaped cell, no allocation.
+        let (rows, _, _) = decode_with(b"plain\n\n", &failing);
+        assert_eq!(rows, 1);
+    }
+
+    #[test]
+    fn test_scratch_reuse() {
+        let mut outstanding: isize = 0;
+        let allocator = NsvAllocator {
+            ctx: &mut outstanding as *mut isize as *mut c_void,
+            alloc: counting_alloc,
+            realloc: counting_realloc,
+            free: counting_free,
+        };
+        let scratch = nsv_scratch_new(&allocator);
+        let input = b"a\\nb\nc\\nd\n\n";
+        let mut offsets = vec![0usize; 4];
+        let mut lengths = vec![0usize; 4];
+        let mut consumed: usize = 0;
+        let mut decode = |cols: &[usize], offsets: &mut [usize], lengths: &mut [usize]| {
+            let needs_unescape = [1u8; 2];
+            nsv_decode_flat(
+                input.as_ptr(),
+                input.len(),
+                0,
+                cols.as_ptr(),
+                cols.len(),
+                needs_unescape.as_ptr(),
+                offsets.as_mut_ptr(),
+                lengths.as_mut_ptr(),
+                2,
+                scratch,
+                &mut consumed,
+            )
+        };
+        let cell = |offset: usize, length: usize| {
+            let data = nsv_scratch_ptr(scratch);
+            unsafe { std::slice::from_raw_parts(data.add(offset & !SCRATCH_BIT), length) }.to_vec()
+        };
+
+        assert_eq!(decode(&[0], &mut offsets, &mut lengths), 1);
+        assert_eq!(cell(offsets[0], lengths[0]), b"a\nb");
+        let first = nsv_scratch_ptr(scratch);
+        let held = outstanding;
+
+        // Reset keeps the allocation; another projection rebuilds the map.
+        nsv_scratch_reset(scratch);
+        assert_eq!(decode(&[1], &mut offsets, &mut lengths), 1);
+        assert_eq!(cell(offsets[0], lengths[0]), b"c\nd");
+        assert_eq!(nsv_scratch_ptr(scratch), first);
+        assert_eq!(outstanding, held);
+
+        // Without a reset, cells are appended.
+        assert_eq!(decode(&[1, 0], &mut offsets, &mut lengths), 1);
+        assert_eq!(cell(offsets[0], lengths[0]), b"c\nd");
+        assert_eq!(cell(offsets[1], lengths[1]), b"a\nb");
+        assert!(offsets[0] & !SCRATCH_BIT > 0);
+
+        nsv_scratch_free(scratch);
+        assert_eq!(outstanding, 0);
+    }
+
+    /// Text of a `string_t` written by `nsv_decode_columns`.
+    fn read_string(value: &[u64; 2]) -> Vec<u8> {
+        let bytes: &[u8; 16] = unsafe { &*(value as *const [u64; 2] as *const [u8; 16]) };
+        let len = u32::from_le_bytes(bytes[..4].try_into().unwrap()) as usize;
+        if len <= STRING_INLINE_LENGTH {
+            return bytes[4..4 + len].to_vec();
+        }
+        let ptr = value[1] as usize as *const u8;
+        unsafe { std::slice::from_raw_parts(ptr, len) }.to_vec()
+    }
+
+    fn is_set(words: &[u64], row: usize) -> bool {
+        words[row / 64] >> (row % 64) & 1 != 0
+    }
+
+    /// Cells of each decoded row; None for NULL.
+    type Rows = Vec<Vec<Option<Vec<u8>>>>;
+
+    /// VARCHAR columns `cols` of `input`, through both decoders.
+    fn decode_both(input: &[u8], cols: &[usize], max_rows: usize) -> (Rows, Rows, usize) {
+        let nc = cols.len();
+        let unescape = vec![1u8; nc];
+        let mut offsets = vec![0usize; max_rows * nc];
+        let mut lengths = vec![0usize; max_rows * nc];
+        let flat_scratch = nsv_scratch_new(std::ptr::null());
+        let mut flat_consumed = 0;
+        let flat_rows = nsv_decode_flat(
+            input.as_ptr(),
+            input.len(),
+            0,
+            cols.as_ptr(),
+            nc,
+            unescape.as_ptr(),
+            offsets.as_mut_ptr(),
+            lengths.as_mut_ptr(),
+            max_rows,
+            flat_scratch,
+            &mut flat_consumed,
+        );
+        let data = nsv_scratch_ptr(flat_scratch);
+        let flat = (0..flat_rows)
+            .map(|r| {
+                (0..nc)
+                    .map(|c| {
+                        let (off, len) = (offsets[r * nc + c], lengths[r * nc + c]);
+                        let cell = if len == 0 {
+                            &[]
+                        } else if off & SCRATCH_BIT != 0 {
+                            unsafe { std::slice::from_raw_parts(data.add(off & !SCRATCH_BIT), len) }
+                        } else {
+                            &input[off..off + len]
+                        };
+                        (len > 0).then(|| cell.to_vec())
+                    })
+                    .collect()
+            })
+            .collect();
+        nsv_scratch_free(flat_scratch);
+
+        let mut strings = vec![vec![[0u64; 2]; max_rows]; nc];
+        let mut validity = vec![vec![0u64; max_rows.div_ceil(64)]; nc];
+        let dests: Vec<NsvColumnDest> = (0..nc)
+            .map(|c| NsvColumnDest {
+                kind: NSV_DEST_VARCHAR,
+                unescape: 1,
+                data: strings[c].as_mut_ptr() as *mut c_void,
+                validity: validity[c].as_mut_ptr(),
+                fallback: std::ptr::null_mut(),
+                fallback_mask: std::ptr::null_mut(),
+            })
+            .collect();
+        let scratch = nsv_scratch_new(std::ptr::null());
+        let mut consumed = 0;
+        let rows = nsv_decode_columns(
+            input.as_ptr(),
+            input.len(),
+            cols.as_ptr(),
+            nc,
+            dests.as_ptr(),
+            max_rows,
+            scratch,
+            &mut consumed,
+        );
+        assert_eq!(rows, flat_rows);
+        assert_eq!(consumed, flat_consumed);
+        let columns = (0..rows)
+            .map(|r| {
+                (0..nc)
+                    .map(|c| is_set(&validity[c], r).then(|| read_string(&strings[c][r])))
+                    .collect()
+            })
+            .collect();
+        nsv_scratch_free(scratch);
+        (flat, columns, rows)
+    }
+
+    #[test]
+    fn test_column_decode_matches_flat() {
+        let long = "a long cell that is not inlined";
+        let escaped = "line one\\nline two, escaped and long";
+        let inputs = [
+            format!("a\n{long}\n\n{escaped}\n\\\n\n\n\n\nx\n\\\\\n"),
+            format!("1\n\\\n{long}\n\n\n2\n\n\n"),
+            "short\n\\n\n\n".to_string(),
+        ];
+        for input in &inputs {
+            for cols in [&[0usize, 1][..], &[1, 0], &[2], &[0]] {
+                for max_rows in [1, 2, 64] {
+                    let (flat, columns, rows) = decode_both(input.as_bytes(), cols, max_rows);
+                    assert!(rows > 0);
+                    assert_eq!(flat, columns, "input {input:?} cols {cols:?}");
+                }
+            }
+        }
+    }
+
+    #[test]
+    fn test_skip_to_row_end() {
+        // Wide rows: the cells after the last projected column are skipped
+        // in one search, including across 64-byte blocks.
+        let wide: String = (0..500).map(|c| format!("c{c}\n")).collect();
+        let input = format!("{wide}\n\\\n{wide}\n\nshort\n\n\n{wide}");
+        for cols in [&[0usize][..], &[2, 0], &[499], &[1, 600]] {
+            for max_rows in [1, 2, 4] {
+                let (flat, columns, rows) = decode_both(input.as_bytes(), cols, max_rows);
+                assert_eq!(rows, max_rows.min(4));
+                assert_eq!(flat, columns);
+            }
+        }
+        let (flat, _, _) = decode_both(input.as_bytes(), &[1, 0], 4);
+        let cell = |s: &str| Some(s.as_bytes().to_vec());
+        assert_eq!(flat[0], [cell("c1"), cell("c0")]);
+        assert_eq!(flat[1], [cell("c0"), None]);
+        assert_eq!(flat[2], [None, cell("short")]);
+        assert_eq!(flat[3], [cell("c1"), cell("c0")]);
+
+        // The row end after the first cell, with every kernel.
+        let long = format!("{}\n\n", "x\n".repeat(40));
+        let longer = format!("{}\n", "x\n".repeat(5000));
+        for (name, kernel) in block_mask_kernels() {
+            let row_end = |input: &[u8]| {
+                let mut structure = Structure::new(input, kernel);
+                structure.next_newline();
+                structure.skip_to_row_end()
+            };
+            assert_eq!(row_end(b"a\nb\n\n"), Some(4), "{name}");
+            assert_eq!(row_end(b"a\n\nb"), Some(2), "{name}");
+            assert_eq!(row_end(b"a\nb\n"), None, "{name}");
+            assert_eq!(row_end(long.as_bytes()), Some(long.len() - 2), "{name}");
+            assert_eq!(row_end(longer.as_bytes()), Some(longer.len() - 1), "{name}");
+        }
+    }
+
+    /// Deterministic pseudo-random NSV-ish bytes, heavy on newlines and
+    /// backslashes.
+    fn structural_noise(seed: u64, len: usize) -> Vec<u8> {
+        let mut x = seed.wrapping_mul(0x9E37_79B9_7F4A_7C15) | 1;
+        (0..len)
+            .map(|_| {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                b"\n\n\\nab"[(x % 6) as usize]
+            })
+            .collect()
+    }
+
+    /// Rows, bytes consumed and cells of `walk_rows_with(kernel, ...)`.
+    fn walk_with(kernel: BlockMasks, input: &[u8], cols: &[usize]) -> (usize, usize, Rows) {
+        let nc = cols.len();
+        let max_rows = input.len() + 1;
+        let mut offsets = vec![0usize; max_rows * nc];
+        let mut lengths = vec![0usize; max_rows * nc];
+        let unescape = vec![1u8; nc];
+        let mut scratch = ScratchBytes {
+            ptr: std::ptr::null_mut(),
+            len: 0,
+            cap: 0,
+            allocator: None,
+        };
+        let mut columns = ColumnMap::default();
+        let (col_map, max_col) = columns.get(cols);
+        let mut sink = FlatSink {
+            offsets: &mut offsets,
+            lengths: &mut lengths,
+            num_cols: nc,
+            unescape_flags: &unescape,
+            input_base_offset: 0,
+            scratch: &mut scratch,
+        };
+        let (rows, consumed) = walk_rows_with(kernel, input, col_map, max_col, max_rows, &mut sink).unwrap();
+        let cells = (0..rows * nc)
+            .map(|i| {
+                let (off, len) = (offsets[i], lengths[i]);
+                (len > 0).then(|| {
+                    if off & SCRATCH_BIT != 0 {
+                        let data = unsafe { scratch.ptr.add(off & !SCRATCH_BIT) };
+                        unsafe { std::slice::from_raw_parts(data, len) }.to_vec()
+                    } else {
+                        input[off..off + len].to_vec()
+                    }
+                })
+            })
+            .collect::<Vec<_>>()
+            .chunks(nc)
+            .map(|row| row.to_vec())
+            .collect();
+        (rows, consumed, cells)
+    }
+
+    #[test]
+    fn test_simd_kernels_match_scalar() {
+        let lengths = [0, 1, 63, 64, 65, 127, 4095, 4096, 4097, 4160, 20000];
+        for (name, kernel) in block_mask_kernels() {
+            for (seed, &len) in lengths.iter().enumerate() {
+                let input = structural_noise(seed as u64 + 1, len);
+                let blocks = len / 64;
+                let (mut nl, mut bs) = (vec![0u64; blocks], vec![0u64; blocks]);
+                let (mut nl_ref, mut bs_ref) = (vec![0u64; blocks], vec![0u64; blocks]);
+                kernel(&input[..blocks * 64], &mut nl, &mut bs);
+                block_masks_scalar(&input[..blocks * 64], &mut nl_ref, &mut bs_ref);
+                assert_eq!((nl, bs), (nl_ref, bs_ref), "{name} masks, len {len}");
+
+                assert_eq!(
+                    count_rows_with(kernel, &input),
+                    count_rows_with(block_masks_scalar, &input),
+                    "{name} count, len {len}"
+                );
+                for cols in [&[0usize][..], &[1, 3], &[2, 0, 5], &[40]] {
+                    let decoded = walk_with(kernel, &input, cols);
+                    let reference = walk_with(block_masks_scalar, &input, cols);
+                    assert_eq!(decoded, reference, "{name} decode, len {len}, cols {cols:?}");
+                    assert_eq!(decoded.0, count_rows(&input), "{name} rows, len {len}");
+                }
+            }
+        }
+    }
+
+    #[test]
+    fn test_column_decode_typed() {
+        let input = b"42\n1.5\ntrue\n\n-7\n1e3\nfalse\n\n+8\nnan\nyes\n\n99999999999999999999\n\n";
+        let cols = [0usize, 1, 2];
+        let mut ints = [0i64; 4];
+        let mut doubles = [0f64; 4];
+        let mut bools = [false; 4];
+        let mut validity = [[0u64; 1]; 3];
+        let mut fallback = [[[0u64; 2]; 4]; 3];
+        let mut fallback_mask = [[0u64; 1]; 3];
+        let data: [*mut c_void; 3] = [
+            ints.as_mut_ptr() as *mut c_void,
+            doubles.as_mut_ptr() as *mut c_void,
+            bools.as_mut_ptr() as *mut c_void,
+        ];
+        let kinds = [NSV_DEST_BIGINT, NSV_DEST_DOUBLE, NSV_DEST_BOOLEAN];
+        let dests: Vec<NsvColumnDest> = (0..3)
+            .map(|c| NsvColumnDest {
+                kind: kinds[c],
+                unescape: 0,
+                data: data[c],
+                validity: validity[c].as_mut_ptr(),
+                fallback: fallback[c].as_mut_ptr() as *mut c_void,
+                fallback_mask: fallback_mask[c].as_mut_ptr(),
+            })
+            .collect();
+        let scratch = nsv_scratch_new(std::ptr::null());
+        let mut consumed = 0;
+        let rows = nsv_decode_columns(
+            input.as_ptr(),
+            input.len(),
+            cols.as_ptr(),
+            3,
+            dests.as_ptr(),
+            4,
+            scratch,
+            &mut consumed,
+        );
+        nsv_scratch_free(scratch);
+        assert_eq!(rows, 4);
+        assert_eq!(consumed, input.len());
+        assert_eq!((ints[0], ints[1]), (42, -7));
+        assert_eq!((doubles[0], doubles[1]), (1.5, 1000.0));
+        assert_eq!((bools[0], bools[1]), (true, false));
+        for c in 0..3 {
+            assert_eq!(validity[c][0], 0b11, "column {c}");
+        }
+        // Cells that do not parse are left to the caller's cast; row 3 has
+        // only its first cell.
+        assert_eq!(fallback_mask, [[0b1100], [0b100], [0b100]]);
+        assert_eq!(read_string(&fallback[0][2]), b"+8");
+        assert_eq!(read_string(&fallback[0][3]), b"99999999999999999999");
+        assert_eq!(read_string(&fallback[1][2]), b"nan");
+        assert_eq!(read_string(&fallback[2][2]), b"yes");
+    }
+
+    #[test]
+    fn test_scratch_detach() {
+        let mut outstanding: isize = 0;
+        let allocator = NsvAllocator {
+            ctx: &mut outstanding as *mut isize as *mut c_void,
+            alloc: counting_alloc,
+            realloc: counting_realloc,
+            free: counting_free,
+        };
+        let input = b"an escaped\\ncell past the inline size\n\n";
+        let cols = [0usize];
+        let mut strings = [[0u64; 2]; 1];
+        let mut validity = [0u64; 1];
+        let dest = NsvColumnDest {
+            kind: NSV_DEST_VARCHAR,
+            unescape: 1,
+            data: strings.as_mut_ptr() as *mut c_void,
+            validity: validity.as_mut_ptr(),
+            fallback: std::ptr::null_mut(),
+            fallback_mask: std::ptr::null_mut(),
+        };
+        let scratch = nsv_scratch_new(&allocator);
+        let mut size = 0;
+        assert!(nsv_scratch_detach(scratch, &mut size).is_null());
+        let mut consumed = 0;
+        let rows =
+            nsv_decode_columns(input.as_ptr(), input.len(), cols.as_ptr(), 1, &dest, 1, scratch, &mut consumed);
+        assert_eq!(rows, 1);
+        assert_eq!(nsv_scratch_len(scratch), b"an escaped\ncell past the inline size".len());
+
+        // The string survives the buffer starting over: it is the caller's.
+        let detached = nsv_scratch_detach(scratch, &mut size);
+        assert!(!detached.is_null());
+        nsv_scratch_reset(scratch);
+        nsv_scratch_free(scratch);
+        assert_eq!(read_string(&strings[0]), b"an escaped\ncell past the inline size");
+        assert_eq!(outstanding, size as isize);
+        counting_free(&mut outstanding as *mut isize as *mut c_void, detached, size);
+        assert_eq!(outstanding, 0);
+    }
+
+    #[test]
+    fn test_large_cell_detach() {
+        let mut outstanding: isize = 0;
+        let allocator = NsvAllocator {
+            ctx: &mut outstanding as *mut isize as *mut c_void,
+            alloc: counting_alloc,
+            realloc: counting_realloc,
+            free: counting_free,
+        };
+        let large = b"ab\\n".repeat(LARGE_CELL_BYTES / 4);
+        let mut input = b"a small\\ncell in scratch\n".to_vec();
+        input.extend_from_slice(&large);
+        input.extend_from_slice(b"\n\n");
+        let cols = [0usize, 1];
+        let mut strings = [[[0u64; 2]; 1]; 2];
+        let mut validity = [[0u64; 1]; 2];
+        let dests: Vec<NsvColumnDest> = (0..2)
+            .map(|c| NsvColumnDest {
+                kind: NSV_DEST_VARCHAR,
+                unescape: 1,
+                data: strings[c].as_mut_ptr() as *mut c_void,
+                validity: validity[c].as_mut_ptr(),
+                fallback: std::ptr::null_mut(),
+                fallback_mask: std::ptr::null_mut(),
+            })
+            .collect();
+        let scratch = nsv_scratch_new(&allocator);
+        let mut consumed = 0;
+        let rows = nsv_decode_columns(
+            input.as_ptr(),
+            input.len(),
+            cols.as_ptr(),
+            2,
+            dests.as_ptr(),
+            1,
+            scratch,
+            &mut consumed,
+        );
+        assert_eq!(rows, 1);
+
+        // The large cell was unescaped once, into its own allocation of the
+        // escaped size; the short one went to scratch as usual.
+        let (mut size, mut column) = (0, usize::MAX);
+        let cell = nsv_scratch_detach_large(scratch, &mut size, &mut column);
+        assert!(!cell.is_null());
+        assert_eq!((column, size), (1, large.len()));
+        assert!(nsv_scratch_detach_large(scratch, &mut size, &mut column).is_null());
+        let mut scratch_size = 0;
+        let detached = nsv_scratch_detach(scratch, &mut scratch_size);
+        assert!(!detached.is_null());
+        nsv_scratch_free(scratch);
+
+        assert_eq!(read_string(&strings[0][0]), b"a small\ncell in scratch");
+        let expected = b"ab\n".repeat(LARGE_CELL_BYTES / 4);
+        assert_eq!(read_string(&strings[1][0]), &expected[..]);
+        let ctx = &mut outstanding as *mut isize as *mut c_void;
+        counting_free(ctx, cell, large.len());
+        counting_free(ctx, detached, scratch_size);
+        assert_eq!(outstanding, 0);
+    }
+
+    #[test]
+    fn test_unescape_simple() {
+        let cells: [&[u8]; 7] = [
+            b"plain",
+            b"a\\nb",
+            b"a\\\\b",
+            b"\\n\\n",
+            b"\\",
+            b"trailing\\",
+            b"other\\tescape",
+        ];
+        for cell in cells {
+            let mut scratch = ScratchBytes::new(None);
+            let len = scratch.extend_unescaped(cell).unwrap();
+            let got = unsafe { std::slice::from_raw_parts(scratch.ptr, len) };
+            assert_eq!(got, &nsv::unescape_bytes(cell)[..], "{:?}", cell);
         }
     }
 
@@ -622,4 +2288,147 @@ mod tests {
         assert_eq!(bytes, b"name\nage\n\nAlice\n30\n\n");
         nsv_free_buf(out_ptr, out_len);
     }
+
+    /// Stand-in for a zstd frame: the magic followed by `payload`. The
+    /// framing code never looks past the magic.
+    fn fake_zstd_frame(payload: &[u8]) -> Vec<u8> {
+        let mut frame = 0xFD2F_B528u32.to_le_bytes().to_vec();
+        frame.extend_from_slice(payload);
+        frame
+    }
+
+    #[test]
+    fn test_detect_compression() {
+        let gzip = [0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff];
+        assert_eq!(
+            nsv_detect_compression(gzip.as_ptr(), gzip.len()),
+            COMPRESSION_GZIP
+        );
+        let zstd = fake_zstd_frame(b"name\nage\n\n");
+        assert_eq!(
+            nsv_detect_compression(zstd.as_ptr(), zstd.len()),
+            COMPRESSION_ZSTD
+        );
+        let skippable = 0x184D_2A5Eu32.to_le_bytes();
+        assert_eq!(
+            nsv_detect_compression(skippable.as_ptr(), skippable.len()),
+            COMPRESSION_ZSTD
+        );
+        let plain = b"name\nage\n\n";
+        assert_eq!(
+            nsv_detect_compression(plain.as_ptr(), plain.len()),
+            COMPRESSION_NONE
+        );
+    }
+
+    #[test]
+    fn test_zstd_seekable_roundtrip() {
+        let blocks: [&[u8]; 3] = [b"name\nage\n\n", b"Alice\n30\n\n", b"Bob\n25\n\n"];
+        let mut file = Vec::new();
+        let mut comp_sizes = Vec::new();
+        let mut decomp_sizes = Vec::new();
+        for block in blocks {
+            let frame = fake_zstd_frame(block);
+            comp_sizes.push(frame.len());
+            decomp_sizes.push(block.len());
+            file.extend(frame);
+        }
+        let mut ptr: *mut u8 = std::ptr::null_mut();
+        let mut len: usize = 0;
+        assert_eq!(
+            nsv_zstd_seek_table(
+                comp_sizes.as_ptr(),
+                decomp_sizes.as_ptr(),
+                3,
+                &mut ptr,
+                &mut len
+            ),
+            0
+        );
+        file.extend_from_slice(unsafe { std::slice::from_raw_parts(ptr, len) });
+        nsv_free_buf(ptr, len);
+
+        let mut comp = [0usize; 3];
+        let mut decomp = [0usize; 3];
+        let n = nsv_zstd_seekable_frames(
+            file.as_ptr(),
+            file.len(),
+            comp.as_mut_ptr(),
+            decomp.as_mut_ptr(),
+            3,
+        );
+        assert_eq!(n, 3);
+        assert_eq!(comp.to_vec(), comp_sizes);
+        assert_eq!(decomp.to_vec(), decomp_sizes);
+        let offset = comp[0];
+        assert_eq!(&file[offset + 4..offset + comp[1]], b"Alice\n30\n\n");
+
+        // A plain zstd stream has no seek table.
+        let plain = fake_zstd_frame(b"a\n\n");
+        assert_eq!(
+            nsv_zstd_seekable_frames(
+                plain.as_ptr(),
+                plain.len(),
+                std::ptr::null_mut(),
+                std::ptr::null_mut(),
+                0
+            ),
+            0
+        );
+    }
+
+    /// Rows found by `nsv_decode_flat` over the whole input.
+    fn decoded_rows(input: &[u8]) -> usize {
+        let cols: [usize; 1] = [0];
+        let needs_unescape: [u8; 1] = [0];
+        let max_rows = input.len() + 1;
+        let mut offsets = vec![0usize; max_rows];
+        let mut lengths = vec![0usize; max_rows];
+        let scratch = nsv_scratch_new(std::ptr::null());
+        let mut consumed: usize = 0;
+        let rows = nsv_decode_flat(
+            input.as_ptr(),
+            input.len(),
+            0,
+            cols.as_ptr(),
+            1,
+            needs_unescape.as_ptr(),
+            offsets.as_mut_ptr(),
+            lengths.as_mut_ptr(),
+            max_rows,
+            scratch,
+            &mut consumed,
+        );
+        nsv_scratch_free(scratch);
+        rows
+    }
+
+    #[test]
+    fn test_count_rows() {
+        assert_eq!(nsv_count_rows(std::ptr::null(), 0), 0);
+        for input in [
+            &b"name\nage\n\nAlice\n30\n\nBob\n25\n\n"[..],
+            b"a\n\n\n\nb\n\n",
+            b"\n\n\na\nb",
+            b"a\n\nb\n",
+            b"\n",
+            b"x",
+        ] {
+            assert_eq!(nsv_count_rows(input.as_ptr(), input.len()), decoded_rows(input));
+        }
+
+        // Row boundaries straddling the 64-byte blocks of the kernel.
+        let mut seed: u64 = 0x9E37_79B9_7F4A_7C15;
+        for len in 0..300 {
+            let input: Vec<u8> = (0..len)
+                .map(|_| {
+                    seed ^= seed << 13;
+                    seed ^= seed >> 7;
+                    seed ^= seed << 17;
+                    if seed % 3 == 0 { b'a' } else { b'\n' }
+                })
+                .collect();
+            assert_eq!(count_rows(&input), decoded_rows(&input), "{:?}", input);
+        }
+    }
 }
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/allocator.hpp"
+
+namespace duckdb {
+
+//! gzip and zstd through the codecs DuckDB itself bundles (miniz and zstd),
+//! so the extension does not link a second copy of either. `compression` is
+//! one of the NSV_COMPRESSION_* values of nsv_ffi.h.
+
+//! Append `data` to `out` as one self-contained gzip member or zstd frame;
+//! blocks compressed separately can be concatenated into a valid stream.
+//! Returns the compressed size.
+size_t NSVCompressBlock(int compression, const uint8_t *data, size_t len,
+                        vector<uint8_t> &out);
+
+//! Inflate a whole gzip (any number of members) or zstd (any number of
+//! frames, skippable ones included) stream into `out`, allocated from
+//! `allocator` so it counts toward memory_limit; its first `out_len` bytes
+//! hold the result. False if the stream is corrupt or truncated.
+bool NSVDecompress(Allocator &allocator, int compression, const uint8_t *data,
+                   size_t len, AllocatedData &out, size_t &out_len);
+
+//! Inflate the single zstd frame `data` into `dst`. Returns the inflated
+//! size, or DConstants::INVALID_INDEX if the frame is corrupt or does not
+//! fit.
+idx_t NSVDecompressFrame(const uint8_t *data, size_t len, uint8_t *dst,
+                         size_t dst_cap);
+
+} // namespace duckdb
@@ -27,12 +27,47 @@ void nsv_sample_free(SampleHandle *h);
  * buffer rather than in the original input buffer. */
 #define NSV_SCRATCH_BIT ((size_t)1 << (sizeof(size_t) * 8 - 1))
 
-/* Opaque scratch buffer for unescaped cell data. */
+/* Opaque per-thread decode state: the unescaped cell data of the current
+ * batch, plus cached column maps. Create it once per scan thread. */
 typedef struct NsvScratchBuf NsvScratchBuf;
 
+/* Allocation callbacks for the scratch buffer, so the host can account for
+ * its memory. realloc keeps the first old_size bytes. A callback returns
+ * NULL when the allocation fails; it must not throw or unwind. */
+typedef struct NsvAllocator {
+  void *ctx;
+  uint8_t *(*alloc)(void *ctx, size_t size);
+  uint8_t *(*realloc)(void *ctx, uint8_t *ptr, size_t old_size,
+                      size_t new_size);
+  void (*free)(void *ctx, uint8_t *ptr, size_t size);
+} NsvAllocator;
+
+/* Create a scratch buffer that allocates through `allocator` (NULL: Rust's
+ * own). The table is copied; its ctx must outlive the buffer. */
+NsvScratchBuf *nsv_scratch_new(const NsvAllocator *allocator);
+
+/* Drop the previous batch's cells. The allocation is kept for the next
+ * batch, unless it grew very large. */
+void nsv_scratch_reset(NsvScratchBuf *buf);
+
 /* Get a pointer to the scratch buffer's data. */
 const uint8_t *nsv_scratch_ptr(const NsvScratchBuf *buf);
 
+/* Bytes of unescaped cells in the scratch buffer. */
+size_t nsv_scratch_len(const NsvScratchBuf *buf);
+
+/* Hand the scratch allocation over to the caller, who frees it through the
+ * buffer's NsvAllocator (*out_size bytes); the buffer starts over empty.
+ * Returns NULL if it holds no cells or uses Rust's allocator. */
+uint8_t *nsv_scratch_detach(NsvScratchBuf *buf, size_t *out_size);
+
+/* Hand over the allocation of one large escaped cell (unescaped into memory
+ * of its own by the last nsv_decode_columns call) like nsv_scratch_detach;
+ * *out_column receives its projected column. Returns NULL once there are
+ * none left, or if the buffer uses Rust's allocator. */
+uint8_t *nsv_scratch_detach_large(NsvScratchBuf *buf, size_t *out_size,
+                                  size_t *out_column);
+
 /* Free a scratch buffer. */
 void nsv_scratch_free(NsvScratchBuf *buf);
 
@@ -46,12 +81,52 @@ void nsv_scratch_free(NsvScratchBuf *buf);
  * remaining bits are the offset into the scratch buffer.
  *
  * Returns the number of rows actually decoded (<= max_rows).
- * *out_scratch receives a handle that must be freed with nsv_scratch_free(). */
+ * Unescaped cells are appended to `scratch`; reset it between batches. If
+ * it cannot grow, the call returns 0 with nothing consumed. */
 size_t nsv_decode_flat(const uint8_t *ptr, size_t len, size_t input_base_offset,
                        const size_t *col_indices, size_t num_cols,
                        const uint8_t *needs_unescape, size_t *out_offsets,
                        size_t *out_lengths, size_t max_rows,
-                       NsvScratchBuf **out_scratch, size_t *out_bytes_consumed);
+                       NsvScratchBuf *scratch, size_t *out_bytes_consumed);
+
+/* ── Column decode (straight into DuckDB vectors) ────────────────── */
+
+#define NSV_DEST_VARCHAR 0
+#define NSV_DEST_BIGINT 1
+#define NSV_DEST_DOUBLE 2
+#define NSV_DEST_BOOLEAN 3
+
+/* Where one projected column goes. `data` is a string_t, int64_t, double or
+ * bool array of max_rows entries; bit r of `validity` (zeroed by the caller)
+ * is set for every non-NULL row r. Typed cells that do not parse are left
+ * to the caller: their raw text goes to the string_t array `fallback`, and
+ * bit r of `fallback_mask` (zeroed by the caller) is set. */
+typedef struct NsvColumnDest {
+  uint32_t kind;
+  /* NSV_DEST_VARCHAR: unescape cells, else keep their raw bytes. */
+  uint32_t unescape;
+  void *data;
+  uint64_t *validity;
+  void *fallback;
+  uint64_t *fallback_mask;
+} NsvColumnDest;
+
+/* Decode up to max_rows rows into `dests` (one per projected column), with
+ * the row rules of nsv_decode_flat. Strings that are not inlined point into
+ * the input or, for unescaped cells, into `scratch`; take the latter over
+ * with nsv_scratch_detach and nsv_scratch_detach_large before the next
+ * reset.
+ *
+ * Returns the number of rows decoded, or 0 with nothing consumed if
+ * `scratch` cannot grow. */
+size_t nsv_decode_columns(const uint8_t *ptr, size_t len,
+                          const size_t *col_indices, size_t num_cols,
+                          const NsvColumnDest *dests, size_t max_rows,
+                          NsvScratchBuf *scratch, size_t *out_bytes_consumed);
+
+/* Count the rows in a chunk of NSV with the same row rules as
+ * nsv_decode_flat, without decoding any cell (COUNT(*)). */
+size_t nsv_count_rows(const uint8_t *ptr, size_t len);
 
 /* ── Writing ─────────────────────────────────────────────────────── */
 
@@ -69,6 +144,30 @@ void nsv_write_chunk(const uint8_t *const *cell_ptrs, const size_t *cell_lens,
 
 void nsv_free_buf(uint8_t *ptr, size_t len);
 
+/* ── Compression ─────────────────────────────────────────────────── */
+
+#define NSV_COMPRESSION_NONE 0
+#define NSV_COMPRESSION_GZIP 1
+#define NSV_COMPRESSION_ZSTD 2
+
+/* Detect gzip / zstd from the leading magic bytes. */
+int nsv_detect_compression(const uint8_t *ptr, size_t len);
+
+/* ── Seekable zstd ───────────────────────────────────────────────── */
+
+/* Build the trailer for a seekable zstd NSV file whose n frames (all ending
+ * on a row boundary) have been written: a row-alignment marker frame followed
+ * by a standard seek table.  Returns 0 on success.  Free with nsv_free_buf. */
+int nsv_zstd_seek_table(const size_t *comp_sizes, const size_t *decomp_sizes,
+                        size_t n, uint8_t **out_ptr, size_t *out_len);
+
+/* Number of data frames in a row-aligned seekable zstd NSV file (0 if the
+ * buffer is not one).  Sizes are filled in when both arrays are non-null and
+ * cap is large enough. */
+size_t nsv_zstd_seekable_frames(const uint8_t *ptr, size_t len,
+                                size_t *out_comp_sizes,
+                                size_t *out_decomp_sizes, size_t cap);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/enums/expression_type.hpp"
+#include "duckdb/common/types/value.hpp"
+#include "duckdb/common/types/vector.hpp"
+
+namespace duckdb {
+
+class FileSystem;
+
+//! Zone map of one column within one index block. min/max are the canonical
+//! VARCHAR forms of values of the column's type.
+struct NSVZone {
+  idx_t null_count = 0;
+  //! False if the block has no non-NULL value, or its bounds are too long to
+  //! be worth storing.
+  bool has_minmax = false;
+  string min;
+  string max;
+};
+
+//! Per-block bloom filters of one column, over the hashes (NSVBloomHash) of
+//! its values' canonical VARCHAR forms.
+struct NSVBloomFilter {
+  static constexpr idx_t BITS_PER_VALUE = 10;
+  static constexpr idx_t NUM_PROBES = 7;
+
+  column_t column = 0;
+  //! Type the column had when the filter was built (LogicalType::ToString()).
+  string type;
+  //! Bit array of each block; empty if the block has no non-NULL value.
+  vector<vector<uint64_t>> blocks;
+
+  //! Build the bit array for a block holding values with these hashes.
+  static vector<uint64_t> BuildBlock(const vector<uint64_t> &hashes);
+  //! False if block `b` holds none of the values with these hashes.
+  bool MayContainAny(idx_t b, const vector<uint64_t> &hashes) const;
+};
+
+//! Stable 64-bit hash used by the bloom filters.
+uint64_t NSVBloomHash(const char *data, idx_t len);
+
+//! Sidecar index for an uncompressed NSV file, stored next to it as
+//! "<file>.nsvidx".
+//!
+//! The file starts with an 8-byte magic, followed by a fixed header that
+//! identifies the indexed file (size, mtime, header flag, data start). After
+//! that come tagged sections (u32 tag, u64 length, payload). A reader skips
+//! any tag it does not know, so new sections do not break older builds. All
+//! integers are stored little-endian.
+struct NSVIndex {
+  //! Rows per block, i.e. between consecutive entries of row_offsets.
+  static constexpr idx_t DEFAULT_ROW_STRIDE = 8192;
+
+  //! Size and modification time (nanoseconds since the epoch, as precise as
+  //! the file system keeps it) of the indexed file. An index whose values
+  //! do not match the file is ignored.
+  idx_t file_size = 0;
+  int64_t file_mtime = 0;
+  bool has_header = true;
+  //! Byte offset of the first data row.
+  idx_t data_start = 0;
+
+  //! Number of data rows (excluding the header).
+  idx_t row_count = 0;
+  idx_t row_stride = DEFAULT_ROW_STRIDE;
+  //! row_offsets[b] is the byte offset of data row b * row_stride.
+  vector<idx_t> row_offsets;
+
+  //! Zone maps, zone_maps[b][c], computed with the column types below
+  //! (LogicalType::ToString()). Empty if the file has none, or if they were
+  //! built for types other than the ones the file is read with.
+  vector<string> column_types;
+  vector<vector<NSVZone>> zone_maps;
+  //! Bloom filters of the columns that were asked for.
+  vector<NSVBloomFilter> bloom_filters;
+
+  //! Bloom filter of `column`, if there is one.
+  const NSVBloomFilter *GetBloomFilter(column_t column) const {
+    for (auto &filter : bloom_filters) {
+      if (filter.column == column) {
+        return &filter;
+      }
+    }
+    return nullptr;
+  }
+
+  idx_t BlockCount() const { return row_offsets.size(); }
+  idx_t BlockRows(idx_t b) const {
+    return MinValue(row_stride, row_count - b * row_stride);
+  }
+  //! Rows in [b * row_stride, ...) live in [row_offsets[b], BlockEnd(b)).
+  idx_t BlockEnd(idx_t b) const {
+    return b + 1 < row_offsets.size() ? row_offsets[b + 1] : file_size;
+  }
+
+  //! Scan `buf` and record the start of every row_stride-th data row.
+  static unique_ptr<NSVIndex> Build(const uint8_t *buf, idx_t len,
+                                    idx_t data_start, bool has_header,
+                                    idx_t row_stride = DEFAULT_ROW_STRIDE);
+
+  static string SidecarPath(const string &path) { return path + ".nsvidx"; }
+
+  //! Load the sidecar of `path`. Returns nullptr if there is none or it was
+  //! built for a different version of the file; throws if it is corrupt.
+  static unique_ptr<NSVIndex> TryLoad(FileSystem &fs, const string &path,
+                                      idx_t file_size, int64_t file_mtime,
+                                      bool has_header);
+
+  //! Write the sidecar of `path`, replacing any existing one.
+  void Write(FileSystem &fs, const string &path) const;
+
+  string Serialize() const;
+  //! Returns nullptr if `data` is not a well-formed index.
+  static unique_ptr<NSVIndex> Deserialize(const string &data);
+};
+
+//! Column names and exact types of an NSV file as COPY TO wrote it, stored
+//! next to it as "<file>.nsvschema" so read_nsv can bind without sampling.
+//!
+//! Same layout rules as NSVIndex: an 8-byte magic, the identifying header
+//! (size and nanosecond mtime of the file on disk, header flag), then the
+//! column count and a (name, LogicalType::ToString()) pair per column,
+//! little-endian.
+struct NSVSchema {
+  idx_t file_size = 0;
+  int64_t file_mtime = 0;
+  bool has_header = true;
+  vector<string> names;
+  vector<string> types;
+
+  static string SidecarPath(const string &path) { return path + ".nsvschema"; }
+
+  //! Load the schema sidecar of `path`. Returns nullptr if there is none or
+  //! it was written for a different version of the file; throws if it is
+  //! corrupt.
+  static unique_ptr<NSVSchema> TryLoad(FileSystem &fs, const string &path,
+                                       idx_t file_size, int64_t file_mtime,
+                                       bool has_header);
+
+  //! Write the schema sidecar of `path`, replacing any existing one.
+  void Write(FileSystem &fs, const string &path) const;
+
+  string Serialize() const;
+  //! Returns nullptr if `data` is not a well-formed schema.
+  static unique_ptr<NSVSchema> Deserialize(const string &data);
+};
+
+//! Accumulates the zone map of one column from decoded vectors.
+struct NSVZoneBuilder {
+  //! Longest min/max kept, in bytes.
+  static constexpr idx_t MAX_BOUND_SIZE = 256;
+
+  idx_t null_count = 0;
+  Value min;
+  Value max;
+  //! Set once a value of a type we cannot compare was seen.
+  bool unsupported = false;
+
+  void Update(Vector &vec, idx_t count);
+  NSVZone Finish() const;
+};
+
+//! `column <comparison> constant` or `column IN (constants)`, taken from a
+//! filter on the scan. Blocks whose zone map or bloom filter rules it out do
+//! not need to be read.
+struct NSVZonePredicate {
+  column_t column;
+  ExpressionType comparison;
+  //! Of the column's type; one, except for COMPARE_IN.
+  vector<Value> constants;
+  //! NSVBloomHash of each constant's VARCHAR form (equality and IN only).
+  vector<uint64_t> hashes;
+
+  //! False only if no row of a block with this zone map can satisfy the
+  //! predicate.
+  bool MayMatch(const NSVZone &zone, idx_t block_rows,
+                const LogicalType &type) const;
+};
+
+//! Skip up to `n` rows starting at the row start `from`, with the decoder's
+//! rules: an empty line ends a row only if the row had cells, and trailing
+//! cells without a final blank line still form a row. Returns the offset just
+//! past the last skipped row; `n` is set to the number of rows skipped.
+size_t NSVSkipRows(const uint8_t *buf, size_t len, size_t from, idx_t &n);
+
+} // namespace duckdb
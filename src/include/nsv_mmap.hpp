@@ -0,0 +1,50 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+//! Read-only mapping of a whole local file. One mapping is shared by every
+//! read_nsv bind of the same version of a file; it is unmapped once the
+//! last reference (including the cache's own) is dropped.
+struct NSVMapping {
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  //! Modification time of the mapped file (nanoseconds since the epoch).
+  int64_t mtime = 0;
+
+  NSVMapping() = default;
+  NSVMapping(const NSVMapping &) = delete;
+  NSVMapping &operator=(const NSVMapping &) = delete;
+  ~NSVMapping();
+};
+
+struct NSVMappingOptions {
+  //! MAP_POPULATE and MADV_HUGEPAGE, applied when the mapping is created.
+  bool populate = false;
+  bool hugepages = false;
+  //! How long an unused mapping stays cached after it was last handed out.
+  int64_t idle_seconds = 0;
+};
+
+//! Map `path`, or share the cached mapping of it. Mappings are keyed by
+//! device, inode, size and mtime, so a file that changed is mapped afresh.
+//! Cached mappings no one uses and that have been idle longer than the
+//! `idle_seconds` of the bind they were last handed out to are dropped
+//! whenever a file is mapped or a mapping is released; there is no
+//! timer. Returns nullptr if the file cannot be
+//! mapped (not a local file, empty, or on Windows).
+shared_ptr<NSVMapping> NSVMapFile(const string &path,
+                                  const NSVMappingOptions &options);
+
+//! Drop a reference NSVMapFile handed out, then drop the cached mappings
+//! that have become idle (including this one, once it is unused and its
+//! idle time is 0).
+void NSVReleaseMapping(shared_ptr<NSVMapping> &mapping);
+
+//! Modification time of the local file `path` in nanoseconds since the
+//! epoch, as NSVMapping::mtime records it. False if `path` is not a local
+//! file (or on Windows).
+bool NSVLocalFileMtime(const string &path, int64_t &mtime);
+
+} // namespace duckdb
@@ -0,0 +1,260 @@
+#include "nsv_compress.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "nsv_ffi.h"
+
+#include "miniz.hpp"
+#include "zstd.h"
+
+#include <cstring>
+
+namespace duckdb {
+
+static constexpr int NSV_ZSTD_LEVEL = 3;
+//! miniz counts bytes in 32 bits: streams are fed to it in pieces.
+static constexpr size_t NSV_MINIZ_CHUNK = 1 << 30;
+//! Smallest output growth step while compressing and while inflating to
+//! an unknown size.
+static constexpr size_t NSV_DEFLATE_MIN_STEP = 64 * 1024;
+static constexpr size_t NSV_INFLATE_MIN_STEP = 1024 * 1024;
+
+static constexpr uint8_t NSV_GZIP_HEADER[] = {0x1f, 0x8b, 8, 0, 0,
+                                              0,    0,    0, 0, 0xff};
+static constexpr size_t NSV_GZIP_FOOTER_SIZE = 8;
+
+static void NSVStoreLE32(vector<uint8_t> &out, uint32_t value) {
+  for (idx_t i = 0; i < 4; i++) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+//! Deflate `data` into one gzip member.
+static void NSVGzipBlock(const uint8_t *data, size_t len,
+                         vector<uint8_t> &out) {
+  duckdb_miniz::mz_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (duckdb_miniz::mz_deflateInit2(&stream, duckdb_miniz::MZ_DEFAULT_LEVEL,
+                                    MZ_DEFLATED, -MZ_DEFAULT_WINDOW_BITS, 8,
+                                    duckdb_miniz::MZ_DEFAULT_STRATEGY) !=
+      duckdb_miniz::MZ_OK) {
+    throw IOException("Failed to compress NSV output block");
+  }
+  out.insert(out.end(), NSV_GZIP_HEADER,
+             NSV_GZIP_HEADER + sizeof(NSV_GZIP_HEADER));
+  duckdb_miniz::mz_ulong crc = MZ_CRC32_INIT;
+  size_t pos = 0;
+  int ret;
+  do {
+    auto piece = MinValue(len - pos, NSV_MINIZ_CHUNK);
+    crc = duckdb_miniz::mz_crc32(crc, data + pos, piece);
+    stream.next_in = data + pos;
+    stream.avail_in = static_cast<unsigned int>(piece);
+    pos += piece;
+    int flush =
+        pos == len ? duckdb_miniz::MZ_FINISH : duckdb_miniz::MZ_NO_FLUSH;
+    // Compressed output rarely exceeds half the input; grow until it fits.
+    do {
+      auto used = out.size();
+      auto room = MaxValue(piece / 2, NSV_DEFLATE_MIN_STEP);
+      out.resize(used + room);
+      stream.next_out = out.data() + used;
+      stream.avail_out = static_cast<unsigned int>(room);
+      ret = duckdb_miniz::mz_deflate(&stream, flush);
+      out.resize(used + room - stream.avail_out);
+      if (ret != duckdb_miniz::MZ_OK && ret != duckdb_miniz::MZ_STREAM_END &&
+          ret != duckdb_miniz::MZ_BUF_ERROR) {
+        duckdb_miniz::mz_deflateEnd(&stream);
+        throw IOException("Failed to compress NSV output block");
+      }
+    } while (stream.avail_out == 0);
+  } while (pos < len);
+  duckdb_miniz::mz_deflateEnd(&stream);
+  if (ret != duckdb_miniz::MZ_STREAM_END) {
+    throw IOException("Failed to compress NSV output block");
+  }
+  NSVStoreLE32(out, static_cast<uint32_t>(crc));
+  NSVStoreLE32(out, static_cast<uint32_t>(len));
+}
+
+size_t NSVCompressBlock(int compression, const uint8_t *data, size_t len,
+                        vector<uint8_t> &out) {
+  auto start = out.size();
+  if (compression == NSV_COMPRESSION_GZIP) {
+    NSVGzipBlock(data, len, out);
+  } else if (compression == NSV_COMPRESSION_ZSTD) {
+    auto bound = duckdb_zstd::ZSTD_compressBound(len);
+    out.resize(start + bound);
+    auto written = duckdb_zstd::ZSTD_compress(out.data() + start, bound, data,
+                                              len, NSV_ZSTD_LEVEL);
+    if (duckdb_zstd::ZSTD_isError(written)) {
+      throw IOException("Failed to compress NSV output block: %s",
+                        duckdb_zstd::ZSTD_getErrorName(written));
+    }
+    out.resize(start + written);
+  } else {
+    throw InternalException("Unknown NSV compression %d", compression);
+  }
+  return out.size() - start;
+}
+
+//! Make room for more than `used` bytes in `buf`, keeping them.
+static void NSVGrowOutput(Allocator &allocator, AllocatedData &buf,
+                          size_t used) {
+  auto size = buf.GetSize();
+  auto grown =
+      allocator.Allocate(MaxValue(size * 2, size + NSV_INFLATE_MIN_STEP));
+  if (used > 0) {
+    memcpy(grown.get(), buf.get(), used);
+  }
+  buf = std::move(grown);
+}
+
+//! Length of the gzip member header at `data`, or 0 if it is not one.
+static size_t NSVGzipHeaderSize(const uint8_t *data, size_t len) {
+  if (len < sizeof(NSV_GZIP_HEADER) || data[0] != 0x1f || data[1] != 0x8b ||
+      data[2] != 8) {
+    return 0;
+  }
+  auto flags = data[3];
+  size_t pos = sizeof(NSV_GZIP_HEADER);
+  if (flags & 0x04) { // FEXTRA
+    if (pos + 2 > len) {
+      return 0;
+    }
+    pos += 2 + (data[pos] | (data[pos + 1] << 8));
+  }
+  for (uint8_t field : {0x08, 0x10}) { // FNAME, FCOMMENT
+    if (flags & field) {
+      while (pos < len && data[pos] != 0) {
+        pos++;
+      }
+      pos++;
+    }
+  }
+  if (flags & 0x02) { // FHCRC
+    pos += 2;
+  }
+  return pos <= len ? pos : 0;
+}
+
+//! Inflate every gzip member of `data`.
+static bool NSVGunzip(Allocator &allocator, const uint8_t *data, size_t len,
+                      AllocatedData &out, size_t &out_len) {
+  out = allocator.Allocate(MaxValue(len * 4, NSV_INFLATE_MIN_STEP));
+  size_t produced = 0;
+  size_t pos = 0;
+  while (pos < len) {
+    auto header = NSVGzipHeaderSize(data + pos, len - pos);
+    if (header == 0) {
+      return false;
+    }
+    pos += header;
+    duckdb_miniz::mz_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (duckdb_miniz::mz_inflateInit2(&stream, -MZ_DEFAULT_WINDOW_BITS) !=
+        duckdb_miniz::MZ_OK) {
+      return false;
+    }
+    int ret;
+    do {
+      if (produced == out.GetSize()) {
+        NSVGrowOutput(allocator, out, produced);
+      }
+      if (stream.avail_in == 0) {
+        stream.next_in = data + pos;
+        stream.avail_in =
+            static_cast<unsigned int>(MinValue(len - pos, NSV_MINIZ_CHUNK));
+      }
+      auto room = MinValue(out.GetSize() - produced, NSV_MINIZ_CHUNK);
+      stream.next_out = out.get() + produced;
+      stream.avail_out = static_cast<unsigned int>(room);
+      auto before_in = stream.avail_in;
+      ret = duckdb_miniz::mz_inflate(&stream, duckdb_miniz::MZ_NO_FLUSH);
+      pos += before_in - stream.avail_in;
+      produced += room - stream.avail_out;
+      // A buffer error with room left means the input ran out mid-member.
+      if ((ret != duckdb_miniz::MZ_OK && ret != duckdb_miniz::MZ_STREAM_END &&
+           ret != duckdb_miniz::MZ_BUF_ERROR) ||
+          (ret == duckdb_miniz::MZ_BUF_ERROR && stream.avail_out != 0 &&
+           pos == len)) {
+        duckdb_miniz::mz_inflateEnd(&stream);
+        return false;
+      }
+    } while (ret != duckdb_miniz::MZ_STREAM_END);
+    duckdb_miniz::mz_inflateEnd(&stream);
+    if (len - pos < NSV_GZIP_FOOTER_SIZE) {
+      return false;
+    }
+    pos += NSV_GZIP_FOOTER_SIZE;
+  }
+  out_len = produced;
+  return true;
+}
+
+//! Inflate every zstd frame of `data`.
+static bool NSVUnzstd(Allocator &allocator, const uint8_t *data, size_t len,
+                      AllocatedData &out, size_t &out_len) {
+  // Frames written by COPY TO record their size: allocate once.
+  auto size = duckdb_zstd::ZSTD_findDecompressedSize(data, len);
+  if (size == ZSTD_CONTENTSIZE_ERROR) {
+    return false;
+  }
+  out = allocator.Allocate(size == ZSTD_CONTENTSIZE_UNKNOWN
+                               ? MaxValue(len * 4, NSV_INFLATE_MIN_STEP)
+                               : size);
+  auto stream = duckdb_zstd::ZSTD_createDStream();
+  if (!stream) {
+    return false;
+  }
+  duckdb_zstd::ZSTD_inBuffer input {data, len, 0};
+  size_t produced = 0;
+  size_t ret = 0;
+  while (true) {
+    duckdb_zstd::ZSTD_outBuffer output {out.get(), out.GetSize(), produced};
+    auto consumed = input.pos;
+    ret = duckdb_zstd::ZSTD_decompressStream(stream, &output, &input);
+    if (duckdb_zstd::ZSTD_isError(ret)) {
+      duckdb_zstd::ZSTD_freeDStream(stream);
+      return false;
+    }
+    bool progress = output.pos != produced || input.pos != consumed;
+    produced = output.pos;
+    // Done once the input is used up and everything decoded was flushed.
+    if (input.pos == len && (ret == 0 || produced < out.GetSize())) {
+      break;
+    }
+    // Stuck: grow a full output (skippable frames decode with none left).
+    if (!progress) {
+      if (produced < out.GetSize()) {
+        duckdb_zstd::ZSTD_freeDStream(stream);
+        return false;
+      }
+      NSVGrowOutput(allocator, out, produced);
+    }
+  }
+  duckdb_zstd::ZSTD_freeDStream(stream);
+  // A non-zero hint means the last frame is truncated.
+  out_len = produced;
+  return ret == 0;
+}
+
+bool NSVDecompress(Allocator &allocator, int compression, const uint8_t *data,
+                   size_t len, AllocatedData &out, size_t &out_len) {
+  if (compression == NSV_COMPRESSION_GZIP) {
+    return NSVGunzip(allocator, data, len, out, out_len);
+  } else if (compression == NSV_COMPRESSION_ZSTD) {
+    return NSVUnzstd(allocator, data, len, out, out_len);
+  }
+  return false;
+}
+
+idx_t NSVDecompressFrame(const uint8_t *data, size_t len, uint8_t *dst,
+                         size_t dst_cap) {
+  auto written = duckdb_zstd::ZSTD_decompress(dst, dst_cap, data, len);
+  if (duckdb_zstd::ZSTD_isError(written)) {
+    return DConstants::INVALID_INDEX;
+  }
+  return written;
+}
+
+} // namespace duckdb
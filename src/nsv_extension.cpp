@@ -2,21 +2,48 @@
 
 #include "nsv_extension.hpp"
 #include "duckdb.hpp"
+#include "duckdb/common/allocator.hpp"
+#include "duckdb/common/error_data.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/file_system.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/optional_idx.hpp"
+#include "duckdb/common/random_engine.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/common/types/timestamp.hpp"
 #include "duckdb/common/types/value.hpp"
 #include "duckdb/common/types/vector.hpp"
 #include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/function/copy_function.hpp"
 #include "duckdb/function/table_function.hpp"
+#include "duckdb/main/config.hpp"
 #include "duckdb/parser/parsed_data/create_copy_function_info.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
-
+#include "duckdb/parser/parsed_data/sample_options.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/storage/statistics/base_statistics.hpp"
+#include "duckdb/storage/statistics/numeric_stats.hpp"
+#include "duckdb/storage/statistics/string_stats.hpp"
+
+#include "duckdb/parallel/task_executor.hpp"
 #include "duckdb/parallel/task_scheduler.hpp"
 
+#include "nsv_compress.hpp"
 #include "nsv_ffi.h"
+#include "nsv_index.hpp"
+#include "nsv_mmap.hpp"
 
 #include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#ifndef DUCKDB_NO_THREADS
+#endif
 
 #ifndef _WIN32
 #include <fcntl.h>
@@ -98,6 +125,27 @@ static size_t FindNextRowBoundary(const uint8_t *buf, size_t buf_len,
 
 // ── read_nsv ────────────────────────────────────────────────────────
 
+//! One zstd frame of a seekable NSV file; frames always hold whole rows.
+struct NSVFrame {
+  //! Position and size of the compressed frame in the file.
+  size_t offset;
+  size_t compressed_size;
+  //! Size of the frame once inflated.
+  size_t size;
+};
+
+//! Keeps the bytes that decoded strings point into alive for as long as a
+//! vector references them: the file's mapping or contents, a range's read
+//! buffer, or cells the decoder unescaped.
+struct NSVStringOwner : public VectorBuffer {
+  NSVStringOwner() : VectorBuffer(VectorBufferType::OPAQUE_BUFFER) {}
+  ~NSVStringOwner() override { NSVReleaseMapping(mapping); }
+
+  shared_ptr<NSVMapping> mapping;
+  //! Memory from the buffer allocator.
+  AllocatedData data;
+};
+
 struct NSVBindData : public TableFunctionData {
   string filename;
   vector<string> names;
@@ -105,57 +153,400 @@ struct NSVBindData : public TableFunctionData {
   //! File data pointer and size.
   const uint8_t *file_data = nullptr;
   size_t file_size = 0;
-#ifndef _WIN32
-  //! If mmap'd: fd and mmap pointer for cleanup.
-  int mmap_fd = -1;
-  void *mmap_ptr = nullptr;
-#endif
-  //! If read into memory: owned buffer (fallback for non-local/Windows files).
-  string read_buffer;
+  //! Size on disk (file_size is the inflated size of compressed input) and
+  //! modification time (nanoseconds since the epoch), to validate sidecars.
+  size_t disk_size = 0;
+  int64_t file_mtime = 0;
+  //! If mmap'd: the mapping, shared with other binds of the same file.
+  shared_ptr<NSVMapping> mapping;
+  //! Owner of the bytes at file_data: the mapping, the file read into
+  //! memory (non-local/Windows files; from the buffer allocator so it
+  //! counts toward memory_limit), or its inflated form. Shared with the
+  //! vectors whose strings point into it, except for a mapping: strings are
+  //! copied out of that.
+  buffer_ptr<NSVStringOwner> contents;
+  //! The file was gzip/zstd compressed and `contents` holds it inflated.
+  bool decompressed = false;
+  //! Seekable zstd: file_data stays compressed and each frame is inflated by
+  //! the thread that scans it. data_start_offset is relative to frame 0.
+  vector<NSVFrame> frames;
+  //! io_mode='async' or direct_io: the file is not mapped. Scan threads read
+  //! their ranges with positional reads through this handle (or direct_fd),
+  //! file_data stays null, and sniffing uses the prefix read at bind.
+  bool async_io = false;
+  unique_ptr<FileHandle> async_handle;
+  //! direct_io=true: ranges are read through this fd, opened with O_DIRECT
+  //! where the file system allows it. Otherwise (o_direct false) it is read
+  //! with plain preads, advised POSIX_FADV_NOREUSE.
+  bool direct_io = false;
+  int direct_fd = -1;
+  bool o_direct = false;
   //! Byte offset where data rows begin (past header row).
   size_t data_start_offset = 0;
   bool all_varchar = false;
   bool has_header = true;
+  //! Fail on cells that do not parse as the column type instead of
+  //! producing NULL (COPY FROM, where the types come from the table).
+  bool strict_cast = false;
+  //! Number of data rows to skip before the scan starts.
+  idx_t skip_rows = 0;
+  //! Row-offset sidecar, when one matches the (uncompressed) file.
+  unique_ptr<NSVIndex> index;
+  //! Filters on the scan that the index's zone maps can prune with. The
+  //! filters themselves stay in the plan.
+  vector<NSVZonePredicate> zone_predicates;
+
+  //! Sniffing reads the prefix NSVLoadFile returned, not file_data.
+  bool SniffsPrefix() const { return !frames.empty() || async_handle; }
 
   ~NSVBindData() {
+    ReleaseFile();
 #ifndef _WIN32
-    if (mmap_ptr && mmap_ptr != MAP_FAILED) {
-      munmap(mmap_ptr, file_size);
-    }
-    if (mmap_fd >= 0) {
-      close(mmap_fd);
+    if (direct_fd >= 0) {
+      close(direct_fd);
     }
 #endif
   }
+
+  //! Drop the raw file contents (mapping or read buffer); vectors with
+  //! strings into them keep them alive until they are done.
+  void ReleaseFile() {
+    contents.reset();
+    NSVReleaseMapping(mapping);
+  }
+};
+
+//! Frames of seekable files must end on a row boundary.
+static bool NSVFrameIsRowAligned(const uint8_t *buf, size_t len) {
+  return len == 0 ||
+         (len >= 2 && buf[len - 2] == '\n' && buf[len - 1] == '\n');
+}
+
+//! Inflate one frame of a seekable file into `out`.
+static void NSVInflateFrame(const NSVBindData &bind, idx_t frame_idx,
+                            vector<uint8_t> &out) {
+  auto &frame = bind.frames[frame_idx];
+  out.resize(frame.size);
+  auto written = NSVDecompressFrame(bind.file_data + frame.offset,
+                                    frame.compressed_size, out.data(),
+                                    out.size());
+  if (written != frame.size || !NSVFrameIsRowAligned(out.data(), out.size())) {
+    throw InvalidInputException("Corrupt frame %d in seekable NSV file: %s",
+                                frame_idx, bind.filename);
+  }
+}
+
+//! A unit of scan work: rows in [start, end) of the file buffer, or of the
+//! inflated frame when `frame` is set.
+struct NSVScanRange {
+  size_t start;
+  size_t end;
+  idx_t frame = DConstants::INVALID_INDEX;
+  //! file_row_number of the range's first row; only known with an index or
+  //! once the row-number pre-pass ran.
+  idx_t first_row = DConstants::INVALID_INDEX;
+  //! start and end are nominal byte offsets; whoever claims the range snaps
+  //! them to row boundaries (NSVResolveRange).
+  bool nominal = false;
+};
+
+//! Virtual columns: the file name, and the 0-based data row number within
+//! the file (rows dropped by `skip` still count).
+static constexpr column_t NSV_COLUMN_FILENAME = VIRTUAL_COLUMN_START;
+static constexpr column_t NSV_COLUMN_FILE_ROW_NUMBER = VIRTUAL_COLUMN_START + 1;
+
+//! What is left of a thread's current range. Idle threads may take the back
+//! half of it (work stealing), so it is only read and changed under `lock`.
+struct NSVWorkerRange {
+  mutex lock;
+  size_t pos = 0;
+  size_t end = 0;
+  //! Plain file range: frames live in the owner's buffer, and a piece split
+  //! off would not know its first_row.
+  bool stealable = false;
 };
 
 struct NSVGlobalState : public GlobalTableFunctionState {
   //! Maps output column index → source column index.
   vector<column_t> column_ids;
-  //! Per-column projection indices for nsv_decode_flat.
+  //! Per-column projection indices for nsv_decode_columns.
   vector<size_t> col_indices;
-  //! Per-column unescape flags (1 = VARCHAR, needs unescape).
-  vector<uint8_t> needs_unescape;
-  //! Work units: byte ranges [start, end) in the raw buffer.
-  vector<pair<size_t, size_t>> ranges;
+  //! Types of the projected columns.
+  vector<LogicalType> col_types;
+  //! Maps output column index → position in col_indices, or INVALID_INDEX
+  //! for virtual columns.
+  vector<idx_t> decoded_column;
+  //! file_row_number is projected, so every range knows its first_row.
+  bool row_numbers = false;
+  //! Work units, handed out in order.
+  vector<NSVScanRange> ranges;
+  //! First row of the scan (past the header and skipped rows), the only
+  //! nominal offset that is already a row start.
+  size_t data_start = 0;
   //! Next range to hand out.
   std::atomic<idx_t> next_range{0};
+  //! No file column is needed (e.g. COUNT(*), or only virtual columns), just
+  //! the rows.
+  bool count_only = false;
+  //! count_only with an index: rows are counted from the index and handed
+  //! out without touching the file. Without one, each range's rows are
+  //! counted by nsv_count_rows.
+  idx_t indexed_rows = 0;
+  std::atomic<idx_t> indexed_rows_claimed{0};
+  //! Index blocks the zone maps, and then the bloom filters, ruled out
+  //! (shown by EXPLAIN ANALYZE).
+  idx_t zone_pruned_blocks = 0;
+  idx_t bloom_pruned_blocks = 0;
+  //! Threads that run out of ranges split the busiest remaining one.
+  bool work_stealing = false;
+  //! Threads the scan runs on: one per range, up to the threads setting.
+  idx_t scan_threads = 1;
+  //! The current range of every thread (one entry per local state).
+  mutex workers_lock;
+  vector<unique_ptr<NSVWorkerRange>> workers;
+
+  idx_t MaxThreads() const override {
+    return MaxValue<idx_t>(ranges.size(), 1);
+  }
+};
+
+//! Bytes prefetched where the next scan call starts decoding. Within a call,
+//! the decoder's structural pass runs a 4 KiB window ahead of the cells it
+//! materializes and prefetches the window after it; this covers the jump to
+//! the next call, whose first window is indexed before anything else.
+static constexpr size_t NSV_PREFETCH_BYTES = 16 * 1024;
+
+//! Software prefetch of [ptr, ptr + len), one cache line at a time.
+static inline void NSVPrefetch(const uint8_t *ptr, size_t len) {
+#if defined(__GNUC__) || defined(__clang__)
+  for (size_t off = 0; off < len; off += 64) {
+    __builtin_prefetch(ptr + off);
+  }
+#else
+  (void)ptr;
+  (void)len;
+#endif
+}
+
+//! Offset, size and memory alignment of O_DIRECT reads.
+static constexpr size_t NSV_DIRECT_IO_ALIGNMENT = 4096;
+
+//! Destination of positional reads. Its memory comes from the buffer
+//! allocator, is aligned for O_DIRECT, and has room up to the next aligned
+//! size, as direct reads only come in whole blocks. Vectors whose strings
+//! point into it share `storage`; it is not written again while they do.
+struct NSVReadBuffer {
+  explicit NSVReadBuffer(Allocator &allocator) : allocator(&allocator) {}
+
+  Allocator *allocator;
+  buffer_ptr<NSVStringOwner> storage;
+  uint8_t *start = nullptr;
+  size_t capacity = 0;
+  size_t length = 0;
+
+  uint8_t *data() const { return start; }
+  size_t size() const { return length; }
+
+  //! Drop the contents before reading something else into the buffer.
+  void clear() { length = 0; }
+
+  //! Keeps the first min(size(), new_length) bytes.
+  void resize(size_t new_length) {
+    size_t needed = AlignValue<size_t, NSV_DIRECT_IO_ALIGNMENT>(new_length);
+    if (needed > capacity || !start || storage.use_count() > 1) {
+      auto grown = make_buffer<NSVStringOwner>();
+      grown->data = allocator->Allocate(needed + NSV_DIRECT_IO_ALIGNMENT);
+      auto addr = reinterpret_cast<uintptr_t>(grown->data.get());
+      auto skew = AlignValue<uintptr_t, NSV_DIRECT_IO_ALIGNMENT>(addr) - addr;
+      auto *aligned = grown->data.get() + skew;
+      if (length > 0) {
+        memcpy(aligned, start, MinValue(length, new_length));
+      }
+      storage = std::move(grown);
+      start = aligned;
+      capacity = needed;
+    }
+    length = new_length;
+  }
+};
+
+//! One read-ahead of an NSVRangeReader, run as a scheduler task.
+class NSVReadAheadTask : public BaseExecutorTask {
+public:
+  NSVReadAheadTask(TaskExecutor &executor, std::function<void()> read)
+      : BaseExecutorTask(executor), read(std::move(read)) {}
+
+  void ExecuteTask() override { read(); }
+
+  string TaskType() const override { return "NSVReadAheadTask"; }
+
+private:
+  std::function<void()> read;
+};
+
+//! io_mode='async' or direct_io: the scan thread's reader, which reads the
+//! range the thread scans next while the current one is decoded. Reads are
+//! tasks on DuckDB's scheduler, so they run on its worker threads (bounded
+//! by the threads setting); one no worker has taken yet by the time it is
+//! needed is run by Wait() itself.
+class NSVRangeReader {
+public:
+  NSVRangeReader() = default;
+  NSVRangeReader(const NSVRangeReader &) = delete;
+  NSVRangeReader &operator=(const NSVRangeReader &) = delete;
+  ~NSVRangeReader();
+
+  //! Before the first Start().
+  void Initialize(ClientContext &ctx) {
+    executor = make_uniq<TaskExecutor>(ctx);
+  }
+  //! Run `read` in the background. Nothing may be pending.
+  void Start(std::function<void()> read);
+  //! Whether a read was started and not yet waited for.
+  bool Pending() const { return pending; }
+  //! Wait for the pending read; rethrows what it threw.
+  void Wait();
+
+private:
+  unique_ptr<TaskExecutor> executor;
+  bool pending = false;
+};
+
+NSVRangeReader::~NSVRangeReader() {
+  // The task refers to the local state's buffers; it has to be done first.
+  if (pending) {
+    try {
+      executor->WorkOnTasks();
+    } catch (std::exception &) {
+    }
+  }
+}
+
+void NSVRangeReader::Start(std::function<void()> read) {
+  D_ASSERT(!pending && executor);
+  pending = true;
+  executor->ScheduleTask(
+      make_uniq<NSVReadAheadTask>(*executor, std::move(read)));
+}
+
+void NSVRangeReader::Wait() {
+  D_ASSERT(pending);
+  pending = false;
+  executor->WorkOnTasks();
+}
+
+//! Routes a thread's Rust scratch buffers through the buffer allocator, so
+//! they count toward memory_limit. Exceptions must not cross the FFI: a
+//! failed allocation is kept here and rethrown once the decode call is back.
+struct NSVScratchAllocator {
+  explicit NSVScratchAllocator(Allocator &allocator);
+  NSVScratchAllocator(const NSVScratchAllocator &) = delete;
+  NSVScratchAllocator &operator=(const NSVScratchAllocator &) = delete;
+
+  Allocator &allocator;
+  ErrorData error;
+  NsvAllocator callbacks;
+
+  void ThrowIfFailed() {
+    if (error.HasError()) {
+      error.Throw();
+    }
+  }
+};
+
+static uint8_t *NSVScratchAlloc(void *ctx, size_t size) {
+  auto &state = *static_cast<NSVScratchAllocator *>(ctx);
+  try {
+    return state.allocator.AllocateData(size);
+  } catch (std::exception &ex) {
+    state.error = ErrorData(ex);
+    return nullptr;
+  }
+}
 
-  idx_t MaxThreads() const override { return ranges.size(); }
+static uint8_t *NSVScratchRealloc(void *ctx, uint8_t *ptr, size_t old_size,
+                                  size_t new_size) {
+  auto &state = *static_cast<NSVScratchAllocator *>(ctx);
+  try {
+    return state.allocator.ReallocateData(ptr, old_size, new_size);
+  } catch (std::exception &ex) {
+    state.error = ErrorData(ex);
+    return nullptr;
+  }
+}
+
+static void NSVScratchFree(void *ctx, uint8_t *ptr, size_t size) {
+  static_cast<NSVScratchAllocator *>(ctx)->allocator.FreeData(ptr, size);
+}
+
+NSVScratchAllocator::NSVScratchAllocator(Allocator &allocator)
+    : allocator(allocator),
+      callbacks {this, NSVScratchAlloc, NSVScratchRealloc, NSVScratchFree} {}
+
+//! Decodes rows straight into the vectors of a chunk (nsv_decode_columns).
+//! VARCHAR cells become strings in place and BIGINT, DOUBLE and BOOLEAN
+//! cells are parsed in place; other types are staged as VARCHAR and cast.
+struct NSVColumnDecoder {
+  Allocator *allocator = nullptr;
+  //! Types of the projected columns.
+  vector<LogicalType> types;
+  vector<NsvColumnDest> dests;
+  //! Vector each projected column is decoded into; set before Prepare().
+  vector<Vector *> targets;
+  //! Per column: the VARCHAR vector a type without a fast path is staged
+  //! in, or that receives the cells a fast path could not parse.
+  vector<unique_ptr<Vector>> staging;
+
+  void Initialize(Allocator &allocator, const vector<LogicalType> &types);
+  //! Point the destinations at `targets`, all rows NULL.
+  void Prepare();
+  //! After nsv_decode_columns returned `count` rows: cast what was staged,
+  //! and make the VARCHAR strings independent of the scratch buffer and of
+  //! `input` (copied, or kept alive by `input_owner` if there is one). A
+  //! null `input` is used up before it changes.
+  void Finish(ClientContext &ctx, const NSVBindData &bind, idx_t count,
+              NsvScratchBuf *scratch, const uint8_t *input, size_t input_len,
+              buffer_ptr<VectorBuffer> input_owner);
 };
 
 struct NSVLocalState : public LocalTableFunctionState {
-  //! Flat arrays sized for STANDARD_VECTOR_SIZE rows.
-  vector<size_t> offsets;
-  vector<size_t> lengths;
-  //! Scratch buffer for unescaped cells (from last decode call).
+  explicit NSVLocalState(Allocator &allocator)
+      : read_buffer(allocator), prefetch_buffer(allocator),
+        scratch_allocator(allocator) {
+    scratch = nsv_scratch_new(&scratch_allocator.callbacks);
+  }
+
+  //! Buffer the current range lives in (file data, frame_buffer or
+  //! read_buffer).
+  const uint8_t *buf = nullptr;
+  //! Inflated frame (seekable zstd only).
+  vector<uint8_t> frame_buffer;
+  //! io_mode='async' or direct_io: the current range, and the one this
+  //! thread scans next, read in the background while the current one is
+  //! decoded.
+  NSVReadBuffer read_buffer;
+  NSVScanRange prefetch_range {0, 0};
+  NSVReadBuffer prefetch_buffer;
+  NSVColumnDecoder decoder;
+  //! Unescaped cells of the current vector; kept for the whole scan so its
+  //! capacity is reused. Only a vector with many unescaped bytes takes it
+  //! over (see NSV_SCRATCH_COPY_BYTES).
   NsvScratchBuf *scratch = nullptr;
-  //! Number of projected columns.
-  idx_t num_cols = 0;
-  //! Current byte position within the assigned range.
+  NSVScratchAllocator scratch_allocator;
+  //! Current byte position within the assigned range. range_end is a copy
+  //! of worker->end, which a thief may lower.
+  size_t range_start = 0;
   size_t byte_pos = 0;
   size_t range_end = 0;
+  NSVWorkerRange *worker = nullptr;
   bool exhausted = true;
+  //! count_only: rows counted in the current range but not yet emitted.
+  idx_t pending_rows = 0;
+  //! file_row_number of the next row the scan emits.
+  idx_t row_number = 0;
+  //! Reads prefetch_range into prefetch_buffer. Declared last: any read in
+  //! flight is finished before the buffers go.
+  NSVRangeReader reader;
 
   ~NSVLocalState() {
     if (scratch) {
@@ -164,366 +555,1862 @@ struct NSVLocalState : public LocalTableFunctionState {
   }
 };
 
-static unique_ptr<FunctionData> NSVBind(ClientContext &ctx,
-                                        TableFunctionBindInput &input,
-                                        vector<LogicalType> &return_types,
-                                        vector<string> &names) {
-  auto result = make_uniq<NSVBindData>();
-  result->filename = input.inputs[0].GetValue<string>();
+//! Bytes read at bind for sniffing in io_mode='async'; doubled until they
+//! hold the sample rows.
+static constexpr idx_t NSV_ASYNC_PREFIX_BYTES = 1024 * 1024;
 
-  auto it = input.named_parameters.find("all_varchar");
-  if (it != input.named_parameters.end()) {
-    result->all_varchar = it->second.GetValue<bool>();
+//! Read `len` bytes at `offset` of the file into `dst` (io_mode='async' or
+//! direct_io). With O_DIRECT, `offset` and `dst` must be aligned and the
+//! whole blocks covering `len` must fit in `dst`.
+static void NSVReadAt(const NSVBindData &bind, uint8_t *dst, size_t len,
+                      size_t offset) {
+#ifndef _WIN32
+  if (bind.direct_fd >= 0) {
+    size_t request = len;
+    if (bind.o_direct) {
+      request = AlignValue<size_t, NSV_DIRECT_IO_ALIGNMENT>(len);
+    }
+    size_t done = 0;
+    while (done < len) {
+      auto n = pread(bind.direct_fd, dst + done, request - done,
+                     static_cast<off_t>(offset + done));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n < 0) {
+        throw IOException("Could not read NSV file \"%s\": %s",
+                          bind.filename, strerror(errno));
+      }
+      if (n == 0) {
+        throw IOException("NSV file \"%s\" was truncated while reading",
+                          bind.filename);
+      }
+      done += static_cast<size_t>(n);
+    }
+    return;
   }
+#endif
+  bind.async_handle->Read(dst, len, offset);
+}
 
-  auto hdr_it = input.named_parameters.find("header");
-  if (hdr_it != input.named_parameters.end()) {
-    result->has_header = hdr_it->second.GetValue<bool>();
+//! direct_io=true: open the fd ranges are read through, with O_DIRECT if
+//! the file system supports it (tmpfs, for one, does not). Without it, the
+//! reads are plain preads marked as used once (POSIX_FADV_NOREUSE): pages
+//! other queries have cached are left alone. Files that cannot be opened
+//! locally keep reading through the FileSystem handle.
+static void NSVOpenDirect(NSVBindData &result) {
+#ifndef _WIN32
+#ifdef O_DIRECT
+  result.direct_fd = open(result.filename.c_str(), O_RDONLY | O_DIRECT);
+  result.o_direct = result.direct_fd >= 0;
+#endif
+  if (result.direct_fd < 0) {
+    result.direct_fd = open(result.filename.c_str(), O_RDONLY);
+#ifdef POSIX_FADV_NOREUSE
+    if (result.direct_fd >= 0) {
+      posix_fadvise(result.direct_fd, 0, 0, POSIX_FADV_NOREUSE);
+    }
+#endif
+  }
+#endif
+}
+
+//! Modification time of the open file `path`, in nanoseconds since the
+//! epoch. Local files are stat'ed for the full precision (as their
+//! mappings are); elsewhere it is whatever the file system reports.
+static int64_t NSVFileMtime(FileSystem &fs, FileHandle &handle,
+                            const string &path) {
+  int64_t mtime;
+  if (NSVLocalFileMtime(path, mtime)) {
+    return mtime;
+  }
+  return Timestamp::GetEpochNanoSeconds(fs.GetLastModifiedTime(handle));
+}
+
+//! io_mode='async' or direct_io: open the file for positional reads and
+//! read just enough of its start to sniff. Returns false, and the file is
+//! loaded as usual, for compressed input or when rows are skipped, which
+//! both need the whole file.
+static bool NSVOpenAsync(ClientContext &ctx, NSVBindData &result,
+                         vector<uint8_t> &prefix) {
+  if (result.skip_rows > 0) {
+    return false;
+  }
+  auto &fs = FileSystem::GetFileSystem(ctx);
+  auto handle = fs.OpenFile(result.filename,
+                            FileFlags::FILE_FLAGS_READ |
+                                FileFlags::FILE_FLAGS_PARALLEL_ACCESS);
+  idx_t file_size = fs.GetFileSize(*handle);
+  result.async_handle = std::move(handle);
+  if (result.direct_io) {
+    NSVOpenDirect(result);
   }
 
-  // Try mmap for local files (avoids kernel→userspace copy).
-  bool use_mmap = false;
+  NSVReadBuffer buffer(BufferAllocator::Get(ctx));
+  buffer.resize(MinValue<idx_t>(file_size, NSV_ASYNC_PREFIX_BYTES));
+  NSVReadAt(result, buffer.data(), buffer.size(), 0);
+  if (nsv_detect_compression(buffer.data(), buffer.size()) !=
+      NSV_COMPRESSION_NONE) {
+    result.async_handle.reset();
 #ifndef _WIN32
-  {
-    int fd = open(result->filename.c_str(), O_RDONLY);
-    if (fd >= 0) {
-      struct stat st;
-      if (fstat(fd, &st) == 0 && st.st_size > 0) {
-        void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-        if (mapped != MAP_FAILED) {
-          madvise(mapped, st.st_size, MADV_SEQUENTIAL);
-          result->mmap_fd = fd;
-          result->mmap_ptr = mapped;
-          result->file_data = reinterpret_cast<const uint8_t *>(mapped);
-          result->file_size = static_cast<size_t>(st.st_size);
-          use_mmap = true;
-        } else {
-          close(fd);
-        }
-      } else {
-        close(fd);
-      }
+    if (result.direct_fd >= 0) {
+      close(result.direct_fd);
+      result.direct_fd = -1;
     }
-  }
 #endif
+    return false;
+  }
+  while (buffer.size() < file_size &&
+         FindNthRowBoundary(buffer.data(), buffer.size(), 0, 1001) >=
+             buffer.size()) {
+    idx_t old_size = buffer.size();
+    idx_t grow = MinValue<idx_t>(file_size - old_size, old_size);
+    buffer.resize(old_size + grow);
+    NSVReadAt(result, buffer.data() + old_size, grow, old_size);
+  }
+  prefix.assign(buffer.data(), buffer.data() + buffer.size());
+  result.file_size = file_size;
+  result.disk_size = file_size;
+  result.file_mtime =
+      NSVFileMtime(fs, *result.async_handle, result.filename);
+  return true;
+}
+
+static bool NSVGetBoolSetting(ClientContext &ctx, const string &name) {
+  Value value;
+  return ctx.TryGetCurrentSetting(name, value) && !value.IsNull() &&
+         value.GetValue<bool>();
+}
+
+//! Map (or read) the file and undo compression. Seekable zstd files stay
+//! compressed; `frame_prefix` receives enough inflated frames to sniff.
+static void NSVLoadFile(ClientContext &ctx, NSVBindData &result,
+                        vector<uint8_t> &frame_prefix) {
+  if ((result.async_io || result.direct_io) &&
+      NSVOpenAsync(ctx, result, frame_prefix)) {
+    return;
+  }
+
+  // Try mmap for local files (avoids kernel→userspace copy). Concurrent
+  // queries on one file share a single mapping.
+  NSVMappingOptions options;
+  options.populate = NSVGetBoolSetting(ctx, "nsv_mmap_populate");
+  options.hugepages = NSVGetBoolSetting(ctx, "nsv_mmap_hugepages");
+  Value idle;
+  if (ctx.TryGetCurrentSetting("nsv_mmap_cache_idle_seconds", idle) &&
+      !idle.IsNull()) {
+    options.idle_seconds = idle.GetValue<int64_t>();
+  }
+  result.mapping = NSVMapFile(result.filename, options);
+  bool use_mmap = result.mapping != nullptr;
+  if (use_mmap) {
+    result.contents = make_buffer<NSVStringOwner>();
+    result.contents->mapping = result.mapping;
+    result.file_data = result.mapping->data;
+    result.file_size = result.mapping->size;
+    result.disk_size = result.file_size;
+    result.file_mtime = result.mapping->mtime;
+  }
 
   if (!use_mmap) {
     auto &fs = FileSystem::GetFileSystem(ctx);
-    auto file_handle =
-        fs.OpenFile(result->filename, FileFlags::FILE_FLAGS_READ);
+    auto file_handle = fs.OpenFile(result.filename, FileFlags::FILE_FLAGS_READ);
     auto file_size = fs.GetFileSize(*file_handle);
-    result->read_buffer.resize(file_size);
-    fs.Read(*file_handle, (void *)result->read_buffer.data(), file_size);
-    result->file_data =
-        reinterpret_cast<const uint8_t *>(result->read_buffer.data());
-    result->file_size = result->read_buffer.size();
+    result.contents = make_buffer<NSVStringOwner>();
+    if (file_size > 0) {
+      auto &data = result.contents->data;
+      data = BufferAllocator::Get(ctx).Allocate(file_size);
+      fs.Read(*file_handle, data.get(), file_size);
+    }
+    result.file_data = result.contents->data.get();
+    result.file_size = file_size;
+    result.disk_size = result.file_size;
+    result.file_mtime = NSVFileMtime(fs, *file_handle, result.filename);
   }
 
-  auto *buf = result->file_data;
-  size_t buf_len = result->file_size;
+  // Seekable zstd written by COPY TO: frames are inflated per scan thread,
+  // only the prefix needed for sniffing is inflated here.
+  int compression = nsv_detect_compression(result.file_data, result.file_size);
+  if (compression == NSV_COMPRESSION_ZSTD) {
+    size_t nframes = nsv_zstd_seekable_frames(
+        result.file_data, result.file_size, nullptr, nullptr, 0);
+    if (nframes > 0) {
+      vector<size_t> comp_sizes(nframes);
+      vector<size_t> sizes(nframes);
+      nsv_zstd_seekable_frames(result.file_data, result.file_size,
+                               comp_sizes.data(), sizes.data(), nframes);
+      size_t offset = 0;
+      for (idx_t i = 0; i < nframes; i++) {
+        result.frames.push_back({offset, comp_sizes[i], sizes[i]});
+        offset += comp_sizes[i];
+      }
+      vector<uint8_t> frame;
+      for (idx_t i = 0; i < nframes; i++) {
+        NSVInflateFrame(result, i, frame);
+        frame_prefix.insert(frame_prefix.end(), frame.begin(), frame.end());
+        if (FindNthRowBoundary(frame_prefix.data(), frame_prefix.size(), 0,
+                               1001) < frame_prefix.size()) {
+          break;
+        }
+      }
+      compression = NSV_COMPRESSION_NONE;
+    }
+  }
+
+  // Other compressed input is inflated once; the scan then sees plain NSV.
+  if (compression != NSV_COMPRESSION_NONE) {
+    auto plain = make_buffer<NSVStringOwner>();
+    size_t plain_len = 0;
+    if (!NSVDecompress(BufferAllocator::Get(ctx), compression,
+                       result.file_data, result.file_size, plain->data,
+                       plain_len)) {
+      throw InvalidInputException("Failed to decompress NSV file: %s",
+                                  result.filename);
+    }
+    result.ReleaseFile();
+    result.contents = std::move(plain);
+    result.decompressed = true;
+    result.file_data = result.contents->data.get();
+    result.file_size = plain_len;
+  }
+}
+
+//! With a header row, data begins at the first row boundary of `buf` (the
+//! file, or the prefix NSVLoadFile returned).
+static void NSVSetDataStart(NSVBindData &result, const uint8_t *buf,
+                            size_t buf_len) {
+  if (!result.has_header) {
+    result.data_start_offset = 0;
+    return;
+  }
+  result.data_start_offset = FindNextRowBoundary(buf, buf_len, 0);
+  if (!result.frames.empty() &&
+      result.data_start_offset > result.frames[0].size) {
+    throw InvalidInputException("Corrupt frame 0 in seekable NSV file: %s",
+                                result.filename);
+  }
+}
+
+//! Sample the start of the file for names, types and where data begins.
+static void NSVSniff(ClientContext &ctx, NSVBindData &result,
+                     const vector<uint8_t> &frame_prefix) {
+  auto *buf = result.file_data;
+  size_t buf_len = result.file_size;
+  if (result.SniffsPrefix()) {
+    buf = frame_prefix.data();
+    buf_len = frame_prefix.size();
+  }
 
   // Decode header + up to 1000 sample rows for type sniffing.
   size_t sample_end = FindNthRowBoundary(buf, buf_len, 0, 1001);
   SampleHandle *sample = nsv_decode_sample(buf, sample_end, 1002);
   if (!sample) {
     throw InvalidInputException("Failed to parse NSV file: %s",
-                                result->filename);
+                                result.filename);
   }
 
   idx_t nrows = nsv_sample_row_count(sample);
   if (nrows == 0) {
     nsv_sample_free(sample);
-    throw InvalidInputException("Empty NSV file: %s", result->filename);
+    throw InvalidInputException("Empty NSV file: %s", result.filename);
   }
 
   idx_t ncols = nsv_sample_col_count(sample, 0);
   idx_t data_start_row;
 
-  if (result->has_header) {
-    // Row 0 = column headers; data starts after first row boundary.
-    result->data_start_offset = FindNextRowBoundary(buf, buf_len, 0);
+  NSVSetDataStart(result, buf, buf_len);
+  if (result.has_header) {
+    // Row 0 = column headers.
     data_start_row = 1;
     for (idx_t i = 0; i < ncols; i++) {
       size_t cell_len = 0;
       const char *cell = nsv_sample_cell(sample, 0, i, &cell_len);
       if (cell && cell_len > 0) {
-        result->names.emplace_back(cell, cell_len);
+        result.names.emplace_back(cell, cell_len);
       } else {
-        result->names.push_back("col" + to_string(i));
+        result.names.push_back("col" + to_string(i));
       }
     }
   } else {
-    // No header: data starts at byte 0; generate column0, column1, ...
-    result->data_start_offset = 0;
+    // No header: generate column0, column1, ...
     data_start_row = 0;
     for (idx_t i = 0; i < ncols; i++) {
-      result->names.push_back("column" + to_string(i));
+      result.names.push_back("column" + to_string(i));
     }
   }
 
   for (idx_t i = 0; i < ncols; i++) {
-    if (result->all_varchar) {
-      result->types.push_back(LogicalType::VARCHAR);
+    if (result.all_varchar) {
+      result.types.push_back(LogicalType::VARCHAR);
     } else {
       auto detected = DetectColumnType(ctx, sample, i, data_start_row, 1000);
-      result->types.push_back(detected);
+      result.types.push_back(detected);
     }
   }
 
   nsv_sample_free(sample);
+}
 
-  names = result->names;
-  return_types = result->types;
-  return std::move(result);
+//! Take names and types from the .nsvschema sidecar COPY TO wrote for this
+//! exact file (`schema_for` is its name), instead of sampling. Returns false
+//! if there is none.
+static bool NSVApplySchema(ClientContext &ctx, NSVBindData &result,
+                           const vector<uint8_t> &frame_prefix,
+                           const string &schema_for) {
+  auto schema = NSVSchema::TryLoad(FileSystem::GetFileSystem(ctx),
+                                   schema_for, result.disk_size,
+                                   result.file_mtime, result.has_header);
+  if (!schema) {
+    return false;
+  }
+  if (result.SniffsPrefix()) {
+    NSVSetDataStart(result, frame_prefix.data(), frame_prefix.size());
+  } else {
+    NSVSetDataStart(result, result.file_data, result.file_size);
+  }
+  result.names = schema->names;
+  for (auto &type : schema->types) {
+    result.types.push_back(TransformStringToLogicalType(type, ctx));
+  }
+  return true;
 }
 
-static unique_ptr<GlobalTableFunctionState>
-NSVInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
-  auto state = make_uniq<NSVGlobalState>();
-  state->column_ids = input.column_ids;
+//! Use the .nsvidx sidecar if one was built for this exact file. Only plain
+//! files are indexed; compressed input is inflated or scanned per frame.
+static void NSVAttachIndex(ClientContext &ctx, NSVBindData &bind) {
+  if (!bind.frames.empty() || bind.decompressed) {
+    return;
+  }
+  auto index =
+      NSVIndex::TryLoad(FileSystem::GetFileSystem(ctx), bind.filename,
+                        bind.file_size, bind.file_mtime, bind.has_header);
+  if (!index || index->data_start != bind.data_start_offset) {
+    return;
+  }
+  // Zone maps only hold for the types they were computed with.
+  bool types_match = index->column_types.size() == bind.types.size();
+  for (idx_t c = 0; types_match && c < bind.types.size(); c++) {
+    types_match = index->column_types[c] == bind.types[c].ToString();
+  }
+  if (!types_match) {
+    index->zone_maps.clear();
+  }
+  auto &blooms = index->bloom_filters;
+  blooms.erase(std::remove_if(blooms.begin(), blooms.end(),
+                              [&](const NSVBloomFilter &filter) {
+                                return filter.column >= bind.types.size() ||
+                                       filter.type !=
+                                           bind.types[filter.column].ToString();
+                              }),
+               blooms.end());
+  bind.index = std::move(index);
+}
 
-  auto &bind = input.bind_data->Cast<NSVBindData>();
+static unique_ptr<FunctionData> NSVBind(ClientContext &ctx,
+                                        TableFunctionBindInput &input,
+                                        vector<LogicalType> &return_types,
+                                        vector<string> &names) {
+  auto result = make_uniq<NSVBindData>();
+  result->filename = input.inputs[0].GetValue<string>();
 
-  // Build projection info for nsv_decode_flat.
-  state->col_indices.reserve(state->column_ids.size());
-  state->needs_unescape.reserve(state->column_ids.size());
-  for (auto &cid : state->column_ids) {
-    state->col_indices.push_back(static_cast<size_t>(cid));
-    state->needs_unescape.push_back(
-        bind.types[cid] == LogicalType::VARCHAR ? 1 : 0);
+  auto it = input.named_parameters.find("all_varchar");
+  if (it != input.named_parameters.end()) {
+    result->all_varchar = it->second.GetValue<bool>();
   }
 
-  // Split data region into ~2MB ranges at \n\n boundaries.
-  auto *buf = bind.file_data;
-  size_t buf_len = bind.file_size;
-  size_t data_start = bind.data_start_offset;
-  size_t data_len = buf_len - data_start;
+  auto hdr_it = input.named_parameters.find("header");
+  if (hdr_it != input.named_parameters.end()) {
+    result->has_header = hdr_it->second.GetValue<bool>();
+  }
 
-  idx_t num_threads = TaskScheduler::GetScheduler(ctx).NumberOfThreads();
-  const size_t TARGET_RANGE_BYTES = 2 * 1024 * 1024;
-  idx_t num_ranges = MaxValue<idx_t>(
-      num_threads * 4, static_cast<idx_t>(data_len / TARGET_RANGE_BYTES));
-  num_ranges = MaxValue<idx_t>(1, MinValue<idx_t>(num_ranges, data_len / 4096));
-  size_t range_size = data_len / num_ranges;
+  auto io_it = input.named_parameters.find("io_mode");
+  if (io_it != input.named_parameters.end()) {
+    auto io_mode = StringUtil::Lower(io_it->second.ToString());
+    if (io_mode != "mmap" && io_mode != "async") {
+      throw BinderException("read_nsv: io_mode must be 'mmap' or 'async'");
+    }
+    result->async_io = io_mode == "async";
+  }
 
-  state->ranges.reserve(num_ranges);
-  size_t pos = data_start;
-  for (idx_t i = 1; i < num_ranges; i++) {
-    size_t nominal = data_start + i * range_size;
-    if (nominal >= buf_len)
-      break;
-    size_t boundary = FindNextRowBoundary(buf, buf_len, nominal);
-    if (boundary < buf_len && boundary > pos) {
-      state->ranges.emplace_back(pos, boundary);
-      pos = boundary;
+  auto direct_it = input.named_parameters.find("direct_io");
+  if (direct_it != input.named_parameters.end()) {
+    result->direct_io = direct_it->second.GetValue<bool>();
+  }
+
+  auto skip_it = input.named_parameters.find("skip");
+  if (skip_it != input.named_parameters.end()) {
+    auto skip = skip_it->second.GetValue<int64_t>();
+    if (skip < 0) {
+      throw BinderException("read_nsv: skip must not be negative");
     }
+    result->skip_rows = static_cast<idx_t>(skip);
   }
-  if (pos < buf_len) {
-    state->ranges.emplace_back(pos, buf_len);
+
+  vector<uint8_t> frame_prefix;
+  NSVLoadFile(ctx, *result, frame_prefix);
+  // all_varchar asks for strings, so the written types do not apply.
+  if (result->all_varchar ||
+      !NSVApplySchema(ctx, *result, frame_prefix, result->filename)) {
+    NSVSniff(ctx, *result, frame_prefix);
   }
+  NSVAttachIndex(ctx, *result);
 
-  return std::move(state);
+  names = result->names;
+  return_types = result->types;
+  return std::move(result);
 }
 
-static unique_ptr<LocalTableFunctionState>
-NSVInitLocal(ExecutionContext &, TableFunctionInitInput &,
-             GlobalTableFunctionState *) {
-  return make_uniq<NSVLocalState>();
+//! COUNT(*) and friends project no column at all; filename and
+//! file_row_number are only produced when a query asks for them.
+static virtual_column_map_t NSVGetVirtualColumns(ClientContext &,
+                                                 optional_ptr<FunctionData>) {
+  virtual_column_map_t result;
+  result.insert(make_pair(COLUMN_IDENTIFIER_EMPTY,
+                          TableColumn("", LogicalType::BOOLEAN)));
+  result.insert(make_pair(NSV_COLUMN_FILENAME,
+                          TableColumn("filename", LogicalType::VARCHAR)));
+  result.insert(make_pair(NSV_COLUMN_FILE_ROW_NUMBER,
+                          TableColumn("file_row_number", LogicalType::BIGINT)));
+  return result;
 }
 
-static void NSVScan(ClientContext &ctx, TableFunctionInput &input,
-                    DataChunk &output) {
-  auto &bind = input.bind_data->Cast<NSVBindData>();
-  auto &gstate = input.global_state->Cast<NSVGlobalState>();
-  auto &lstate = input.local_state->Cast<NSVLocalState>();
-
-  auto *file_buf = bind.file_data;
-  idx_t nc = static_cast<idx_t>(gstate.col_indices.size());
-
-  // Ensure flat arrays are allocated (once).
-  size_t cap = STANDARD_VECTOR_SIZE * nc;
-  if (lstate.offsets.size() < cap) {
-    lstate.offsets.resize(cap);
-    lstate.lengths.resize(cap);
-    lstate.num_cols = nc;
+//! Collect `column <op> constant` and `column IN (constants)` filters for
+//! pruning with zone maps and bloom filters. Nothing is removed from
+//! `filters`, so DuckDB still applies every one of them.
+static void NSVPushdownComplexFilter(ClientContext &, LogicalGet &get,
+                                     FunctionData *bind_data,
+                                     vector<unique_ptr<Expression>> &filters) {
+  auto &bind = bind_data->Cast<NSVBindData>();
+  if (!bind.index || (bind.index->zone_maps.empty() &&
+                      bind.index->bloom_filters.empty())) {
+    return;
   }
-
-  // Grab ranges until we get data or run out.
-  for (;;) {
-    if (lstate.exhausted || lstate.byte_pos >= lstate.range_end) {
-      idx_t range_idx = gstate.next_range.fetch_add(1);
-      if (range_idx >= static_cast<idx_t>(gstate.ranges.size())) {
-        output.SetCardinality(0);
-        return;
+  auto &column_ids = get.GetColumnIds();
+  for (auto &filter : filters) {
+    NSVZonePredicate predicate;
+    Expression *column;
+    vector<Expression *> constants;
+    if (filter->GetExpressionClass() == ExpressionClass::BOUND_COMPARISON) {
+      auto &comparison = filter->Cast<BoundComparisonExpression>();
+      column = comparison.left.get();
+      auto *constant = comparison.right.get();
+      predicate.comparison = comparison.GetExpressionType();
+      if (column->GetExpressionClass() == ExpressionClass::BOUND_CONSTANT) {
+        std::swap(column, constant);
+        predicate.comparison = FlipComparisonExpression(predicate.comparison);
       }
-      lstate.byte_pos = gstate.ranges[range_idx].first;
-      lstate.range_end = gstate.ranges[range_idx].second;
-      lstate.exhausted = false;
-    }
-
-    // Free previous scratch.
-    if (lstate.scratch) {
-      nsv_scratch_free(lstate.scratch);
-      lstate.scratch = nullptr;
-    }
-
-    // Decode up to STANDARD_VECTOR_SIZE rows via Rust FFI.
-    size_t chunk_len = lstate.range_end - lstate.byte_pos;
-    NsvScratchBuf *scratch = nullptr;
-    size_t bytes_consumed = 0;
-    size_t decoded = nsv_decode_flat(
-        file_buf + lstate.byte_pos, chunk_len, lstate.byte_pos,
-        gstate.col_indices.data(), nc, gstate.needs_unescape.data(),
-        lstate.offsets.data(), lstate.lengths.data(), STANDARD_VECTOR_SIZE,
-        &scratch, &bytes_consumed);
-
-    lstate.scratch = scratch;
-    lstate.byte_pos += bytes_consumed;
-
-    if (decoded > 0) {
-      idx_t count = static_cast<idx_t>(decoded);
-      const uint8_t *scratch_ptr = scratch ? nsv_scratch_ptr(scratch) : nullptr;
-
-      for (idx_t out_col = 0; out_col < output.ColumnCount(); out_col++) {
-        idx_t src_col = gstate.column_ids[out_col];
-        auto &vec = output.data[out_col];
-        const auto &target_type = bind.types[src_col];
-
-        if (target_type == LogicalType::VARCHAR) {
-          // VARCHAR: write strings directly into the output vector.
-          auto str_data = FlatVector::GetData<string_t>(vec);
-          auto &validity = FlatVector::Validity(vec);
-
-          for (idx_t i = 0; i < count; i++) {
-            size_t idx = i * nc + out_col;
-            size_t off = lstate.offsets[idx];
-            size_t len = lstate.lengths[idx];
-            if (len == 0) {
-              validity.SetInvalid(i);
-            } else {
-              const char *cell;
-              if (off & NSV_SCRATCH_BIT) {
-                cell = reinterpret_cast<const char *>(scratch_ptr +
-                                                      (off & ~NSV_SCRATCH_BIT));
-              } else {
-                cell = reinterpret_cast<const char *>(file_buf + off);
-              }
-              str_data[i] = StringVector::AddString(vec, cell, len);
-            }
-          }
-        } else {
-          // Typed columns: populate VARCHAR vector, then batch-cast.
-          Vector str_vec(LogicalType::VARCHAR, count);
-          auto str_data = FlatVector::GetData<string_t>(str_vec);
-          auto &str_validity = FlatVector::Validity(str_vec);
-
-          for (idx_t i = 0; i < count; i++) {
-            size_t idx = i * nc + out_col;
-            size_t off = lstate.offsets[idx];
-            size_t len = lstate.lengths[idx];
-            if (len == 0) {
-              str_validity.SetInvalid(i);
-            } else {
-              const char *cell;
-              if (off & NSV_SCRATCH_BIT) {
-                cell = reinterpret_cast<const char *>(scratch_ptr +
-                                                      (off & ~NSV_SCRATCH_BIT));
-              } else {
-                cell = reinterpret_cast<const char *>(file_buf + off);
-              }
-              str_data[i] = StringVector::AddString(str_vec, cell, len);
-            }
-          }
-
-          string error_msg;
-          VectorOperations::TryCast(ctx, str_vec, vec, count, &error_msg,
-                                    false);
-        }
+      constants.push_back(constant);
+    } else if (filter->GetExpressionType() == ExpressionType::COMPARE_IN) {
+      auto &in = filter->Cast<BoundOperatorExpression>();
+      column = in.children[0].get();
+      for (idx_t i = 1; i < in.children.size(); i++) {
+        constants.push_back(in.children[i].get());
       }
-
-      output.SetCardinality(count);
-      return;
+      predicate.comparison = ExpressionType::COMPARE_IN;
+    } else {
+      continue;
     }
 
-    // decoded == 0: range exhausted, loop to grab next range.
-    lstate.exhausted = true;
+    if (column->GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) {
+      continue;
+    }
+    auto &colref = column->Cast<BoundColumnRefExpression>();
+    if (colref.binding.table_index != get.table_index) {
+      continue;
+    }
+    auto &column_id = column_ids[colref.binding.column_index];
+    predicate.column = column_id.GetPrimaryIndex();
+    if (predicate.column >= bind.types.size()) {
+      continue;
+    }
+    auto &type = bind.types[predicate.column];
+    bool usable = true;
+    for (auto *constant : constants) {
+      if (constant->GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+        usable = false;
+        break;
+      }
+      auto &value = constant->Cast<BoundConstantExpression>().value;
+      if (value.IsNull() || value.type() != type) {
+        usable = false;
+        break;
+      }
+      auto str = value.ToString();
+      predicate.constants.push_back(value);
+      predicate.hashes.push_back(NSVBloomHash(str.data(), str.size()));
+    }
+    if (usable) {
+      bind.zone_predicates.push_back(std::move(predicate));
+    }
   }
 }
 
-// ── write_nsv (COPY TO) ────────────────────────────────────────────
-
-struct NSVWriteBindData : public TableFunctionData {
-  vector<string> names;
-  vector<LogicalType> types;
-  bool write_header = true;
-};
-
-struct NSVWriteGlobalState : public GlobalFunctionData {
-  string filename;
-  unique_ptr<FileHandle> file_handle;
-  bool header_written = false;
-};
-
-struct NSVWriteLocalState : public LocalFunctionData {};
-
-static unique_ptr<FunctionData> NSVWriteBind(ClientContext &,
-                                             CopyFunctionBindInput &input,
-                                             const vector<string> &names,
-                                             const vector<LogicalType> &types) {
-  auto result = make_uniq<NSVWriteBindData>();
-  result->names = names;
-  result->types = types;
+//! Column bounds from the index's zone maps, for the optimizer.
+static unique_ptr<BaseStatistics> NSVStatistics(ClientContext &,
+                                                const FunctionData *bind_data,
+                                                column_t column_index) {
+  auto &bind = bind_data->Cast<NSVBindData>();
+  if (!bind.index || bind.index->zone_maps.empty() ||
+      column_index >= bind.types.size()) {
+    return nullptr;
+  }
+  auto &index = *bind.index;
+  auto &type = bind.types[column_index];
+  auto stats_type = BaseStatistics::GetStatsType(type);
+  if (stats_type != StatisticsType::NUMERIC_STATS &&
+      stats_type != StatisticsType::STRING_STATS) {
+    return nullptr;
+  }
 
-  auto it = input.info.options.find("header");
-  if (it != input.info.options.end()) {
-    result->write_header = it->second[0].GetValue<bool>();
+  Value min;
+  Value max;
+  bool has_null = false;
+  bool has_value = false;
+  for (idx_t b = 0; b < index.BlockCount(); b++) {
+    auto &zone = index.zone_maps[b][column_index];
+    has_null = has_null || zone.null_count > 0;
+    if (zone.null_count >= index.BlockRows(b)) {
+      continue;
+    }
+    has_value = true;
+    Value lo;
+    Value hi;
+    if (!zone.has_minmax || !Value(zone.min).DefaultTryCastAs(type, lo) ||
+        !Value(zone.max).DefaultTryCastAs(type, hi)) {
+      return nullptr;
+    }
+    if (min.IsNull() || lo < min) {
+      min = lo;
+    }
+    if (max.IsNull() || hi > max) {
+      max = hi;
+    }
   }
 
-  return std::move(result);
+  auto stats = BaseStatistics::CreateEmpty(type);
+  if (has_value) {
+    if (stats_type == StatisticsType::NUMERIC_STATS) {
+      NumericStats::SetMin(stats, min);
+      NumericStats::SetMax(stats, max);
+    } else {
+      auto &lo = StringValue::Get(min);
+      auto &hi = StringValue::Get(max);
+      StringStats::Update(stats, string_t(lo));
+      StringStats::Update(stats, string_t(hi));
+      // Only the bounds were seen, not every string.
+      StringStats::ResetMaxStringLength(stats);
+      StringStats::SetContainsUnicode(stats);
+    }
+    stats.SetHasNoNull();
+  }
+  if (has_null) {
+    stats.SetHasNull();
+  }
+  return stats.ToUnique();
 }
 
-static unique_ptr<GlobalFunctionData>
-NSVWriteInitGlobal(ClientContext &ctx, FunctionData &bind_data,
-                   const string &filename) {
-  auto result = make_uniq<NSVWriteGlobalState>();
-  result->filename = filename;
-  auto &fs = FileSystem::GetFileSystem(ctx);
-  result->file_handle =
-      fs.OpenFile(filename, FileFlags::FILE_FLAGS_WRITE |
-                                FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
-  return std::move(result);
+//! How many ranges to cut `data_len` bytes into: at least 4 per thread and
+//! about 2MB each, but no smaller than 4KB.
+static idx_t NSVTargetRangeCount(ClientContext &ctx, size_t data_len) {
+  idx_t num_threads = TaskScheduler::GetScheduler(ctx).NumberOfThreads();
+  const size_t TARGET_RANGE_BYTES = 2 * 1024 * 1024;
+  idx_t num_ranges = MaxValue<idx_t>(
+      num_threads * 4, static_cast<idx_t>(data_len / TARGET_RANGE_BYTES));
+  return MaxValue<idx_t>(1, MinValue<idx_t>(num_ranges, data_len / 4096));
 }
 
-static unique_ptr<LocalFunctionData> NSVWriteInitLocal(ExecutionContext &,
-                                                       FunctionData &) {
-  return make_uniq<NSVWriteLocalState>();
+//! Seekable zstd: one range per frame, frames already end on rows.
+static void NSVPlanFrameRanges(const NSVBindData &bind,
+                               NSVGlobalState &state) {
+  idx_t first_frame = 0;
+  size_t first_start = bind.data_start_offset;
+  if (bind.skip_rows > 0) {
+    // Skipped rows have to be inflated to be counted.
+    idx_t skip = bind.skip_rows;
+    vector<uint8_t> frame;
+    for (; first_frame < bind.frames.size(); first_frame++) {
+      NSVInflateFrame(bind, first_frame, frame);
+      idx_t n = skip;
+      first_start = NSVSkipRows(frame.data(), frame.size(),
+                                first_frame == 0 ? first_start : 0, n);
+      skip -= n;
+      if (skip == 0) {
+        break;
+      }
+    }
+  }
+  for (idx_t i = first_frame; i < bind.frames.size(); i++) {
+    size_t start = i == first_frame ? first_start : 0;
+    if (start < bind.frames[i].size) {
+      state.ranges.push_back({start, bind.frames[i].size, i});
+    }
+  }
 }
 
-static void NSVWriteSink(ExecutionContext &context, FunctionData &bind_data,
-                         GlobalFunctionData &gstate, LocalFunctionData &,
-                         DataChunk &input) {
-  auto &bind = bind_data.Cast<NSVWriteBindData>();
-  auto &state = gstate.Cast<NSVWriteGlobalState>();
+//! False if the zone maps or bloom filters rule out every row of index
+//! block `b`.
+static bool NSVBlockMayMatch(const NSVBindData &bind, idx_t b,
+                             NSVGlobalState &state) {
+  auto &index = *bind.index;
+  for (auto &predicate : bind.zone_predicates) {
+    if (!index.zone_maps.empty() &&
+        !predicate.MayMatch(index.zone_maps[b][predicate.column],
+                            index.BlockRows(b), bind.types[predicate.column])) {
+      state.zone_pruned_blocks++;
+      return false;
+    }
+    if (predicate.comparison != ExpressionType::COMPARE_EQUAL &&
+        predicate.comparison != ExpressionType::COMPARE_IN) {
+      continue;
+    }
+    auto bloom = index.GetBloomFilter(predicate.column);
+    if (bloom && !bloom->MayContainAny(b, predicate.hashes)) {
+      state.bloom_pruned_blocks++;
+      return false;
+    }
+  }
+  return true;
+}
 
-  auto &fs = FileSystem::GetFileSystem(context.client);
+//! With an index, ranges are runs of whole index blocks with the same number
+//! of rows, and OFFSET-style skipping only walks the rows of one block.
+//! Blocks the zone maps rule out are left out.
+static void NSVPlanIndexRanges(ClientContext &ctx, const NSVBindData &bind,
+                               NSVGlobalState &state) {
+  auto &index = *bind.index;
+  if (bind.skip_rows >= index.row_count) {
+    return;
+  }
+  idx_t first_block = bind.skip_rows / index.row_stride;
+  idx_t n = bind.skip_rows % index.row_stride;
+  size_t start = NSVSkipRows(bind.file_data, bind.file_size,
+                             index.row_offsets[first_block], n);
+
+  vector<idx_t> blocks;
+  for (idx_t b = first_block; b < index.BlockCount(); b++) {
+    if (NSVBlockMayMatch(bind, b, state)) {
+      blocks.push_back(b);
+    }
+  }
+  if (blocks.empty()) {
+    return;
+  }
 
-  if (!state.header_written && bind.write_header) {
-    NsvEncoder *enc = nsv_encoder_new();
-    for (auto &name : bind.names) {
-      nsv_encoder_push_cell(enc, reinterpret_cast<const uint8_t *>(name.data()),
-                            name.size());
+  idx_t num_ranges = MinValue<idx_t>(
+      blocks.size(), NSVTargetRangeCount(ctx, bind.file_size - start));
+  state.ranges.reserve(num_ranges);
+  for (idx_t r = 0; r < num_ranges; r++) {
+    idx_t begin = r * blocks.size() / num_ranges;
+    idx_t end = (r + 1) * blocks.size() / num_ranges;
+    for (idx_t i = begin; i < end; i++) {
+      auto b = blocks[i];
+      if (i > begin && blocks[i - 1] + 1 == b) {
+        // Adjacent in the file: extend the current range.
+        state.ranges.back().end = index.BlockEnd(b);
+        continue;
+      }
+      size_t block_start = b == first_block ? start : index.row_offsets[b];
+      idx_t first_row =
+          b == first_block ? bind.skip_rows : b * index.row_stride;
+      state.ranges.push_back({block_start, index.BlockEnd(b),
+                              DConstants::INVALID_INDEX, first_row});
     }
-    nsv_encoder_end_row(enc);
-    uint8_t *hdr = nullptr;
-    size_t hdr_len = 0;
-    nsv_encoder_finish(enc, &hdr, &hdr_len);
-    if (hdr && hdr_len > 0) {
-      fs.Write(*state.file_handle, (void *)hdr, hdr_len);
-      nsv_free_buf(hdr, hdr_len);
+  }
+}
+
+//! Size of the first byte range; the ranges after it double until they reach
+//! the regular range size.
+static constexpr size_t NSV_RAMP_RANGE_BYTES = 64 * 1024;
+
+//! Split the data region into nominal byte ranges. Nothing is read here:
+//! each range is snapped to row boundaries by the thread that claims it, so
+//! planning does not fault in pages all over the file.
+//!
+//! The first ranges are small and grow, so the first threads all start near
+//! the beginning of the file (already paged in by sniffing). A LIMIT preview
+//! is then served from there instead of from num_threads far-apart regions
+//! of a cold file.
+static void NSVPlanByteRanges(ClientContext &ctx, const NSVBindData &bind,
+                              NSVGlobalState &state) {
+  size_t buf_len = bind.file_size;
+  size_t data_start = bind.data_start_offset;
+  if (bind.skip_rows > 0) {
+    idx_t n = bind.skip_rows;
+    data_start = NSVSkipRows(bind.file_data, buf_len, data_start, n);
+  }
+  state.data_start = data_start;
+  if (data_start >= buf_len) {
+    return;
+  }
+  size_t data_len = buf_len - data_start;
+  idx_t num_ranges = NSVTargetRangeCount(ctx, data_len);
+  size_t range_size = data_len / num_ranges;
+
+  vector<size_t> splits {data_start};
+  size_t pos = data_start;
+  for (size_t ramp = NSV_RAMP_RANGE_BYTES;
+       ramp < range_size && buf_len - pos > 2 * range_size; ramp *= 2) {
+    pos += ramp;
+    splits.push_back(pos);
+  }
+  range_size = (buf_len - pos) / num_ranges;
+  for (idx_t i = 1; i < num_ranges; i++) {
+    splits.push_back(pos + i * range_size);
+  }
+  splits.push_back(buf_len);
+
+  state.ranges.reserve(splits.size() - 1);
+  for (idx_t i = 0; i + 1 < splits.size(); i++) {
+    if (splits[i] < splits[i + 1]) {
+      NSVScanRange range {splits[i], splits[i + 1]};
+      range.nominal = true;
+      state.ranges.push_back(range);
+    }
+  }
+}
+
+//! Snap a nominal range to row boundaries: both ends move to the first
+//! \n\n boundary at or after them. Neighbouring ranges share an end, so
+//! they snap to the same boundary and every row lands in exactly one range
+//! (possibly leaving a range empty).
+static void NSVResolveRange(const NSVBindData &bind,
+                            const NSVGlobalState &state,
+                            NSVScanRange &range) {
+  auto snap = [&](size_t offset) {
+    if (offset == state.data_start || offset >= bind.file_size) {
+      return offset;
+    }
+    return FindNextRowBoundary(bind.file_data, bind.file_size, offset);
+  };
+  range.start = snap(range.start);
+  range.end = MaxValue(range.start, snap(range.end));
+  range.nominal = false;
+}
+
+//! Extra bytes read past a range's nominal end in io_mode='async', where its
+//! last row most likely ends.
+static constexpr size_t NSV_ASYNC_OVERREAD_BYTES = 64 * 1024;
+
+//! io_mode='async' or direct_io: read the rows of `range` into `buffer` and
+//! make the range relative to it. Nominal ends are snapped like
+//! NSVResolveRange does, reading further past the end until its boundary is
+//! in the buffer. O_DIRECT reads cover whole aligned blocks, so the buffer
+//! may start before the range and end after it; rows straddling a block
+//! edge are whole once the range is snapped. Returns the file offset the
+//! buffer starts at.
+static size_t NSVReadRange(const NSVBindData &bind,
+                           const NSVGlobalState &state, NSVScanRange &range,
+                           NSVReadBuffer &buffer) {
+  size_t align = bind.o_direct ? NSV_DIRECT_IO_ALIGNMENT : 1;
+  size_t file_size = bind.file_size;
+  size_t read_start = range.start / align * align;
+  size_t read_end = range.end;
+  if (range.nominal) {
+    read_end += NSV_ASYNC_OVERREAD_BYTES;
+  }
+  read_end = MinValue(file_size, (read_end + align - 1) / align * align);
+  buffer.clear();
+  buffer.resize(read_end - read_start);
+  NSVReadAt(bind, buffer.data(), buffer.size(), read_start);
+  if (!range.nominal) {
+    range.start -= read_start;
+    range.end -= read_start;
+    return read_start;
+  }
+
+  size_t end = range.end;
+  while (end < file_size) {
+    size_t boundary =
+        FindNextRowBoundary(buffer.data(), buffer.size(), end - read_start);
+    if (boundary < buffer.size() || read_end >= file_size) {
+      end = read_start + boundary;
+      break;
+    }
+    size_t old_size = buffer.size();
+    size_t grow = MinValue(file_size - read_end, old_size);
+    buffer.resize(old_size + grow);
+    NSVReadAt(bind, buffer.data() + old_size, grow, read_end);
+    read_end += grow;
+  }
+  size_t start = range.start - read_start;
+  if (range.start != state.data_start) {
+    start = FindNextRowBoundary(buffer.data(), buffer.size(), start);
+  }
+  range.start = start;
+  range.end = MaxValue(start, end - read_start);
+  range.nominal = false;
+  return read_start;
+}
+
+//! Counts the rows of a slice of the planned ranges.
+class NSVCountRangesTask : public BaseExecutorTask {
+public:
+  NSVCountRangesTask(TaskExecutor &executor, Allocator &allocator,
+                     const NSVBindData &bind, NSVGlobalState &state,
+                     vector<idx_t> &counts, idx_t begin, idx_t end)
+      : BaseExecutorTask(executor), allocator(allocator), bind(bind),
+        state(state), counts(counts), begin(begin), end(end) {}
+
+  void ExecuteTask() override {
+    vector<uint8_t> frame;
+    NSVReadBuffer read_buffer(allocator);
+    for (idx_t i = begin; i < end; i++) {
+      if (bind.async_handle) {
+        // Keep the snapped range (in file offsets), so the scan reads just
+        // its rows instead of reading past its end to snap it again.
+        auto &range = state.ranges[i];
+        auto read_start = NSVReadRange(bind, state, range, read_buffer);
+        counts[i] = nsv_count_rows(read_buffer.data() + range.start,
+                                   range.end - range.start);
+        range.start += read_start;
+        range.end += read_start;
+        continue;
+      }
+      auto &range = state.ranges[i];
+      if (range.nominal) {
+        NSVResolveRange(bind, state, range);
+      }
+      const uint8_t *buf = bind.file_data;
+      if (range.frame != DConstants::INVALID_INDEX) {
+        NSVInflateFrame(bind, range.frame, frame);
+        buf = frame.data();
+      }
+      counts[i] = nsv_count_rows(buf + range.start, range.end - range.start);
+    }
+  }
+
+  string TaskType() const override { return "NSVCountRangesTask"; }
+
+private:
+  Allocator &allocator;
+  const NSVBindData &bind;
+  NSVGlobalState &state;
+  vector<idx_t> &counts;
+  idx_t begin;
+  idx_t end;
+};
+
+//! Give every range its first file_row_number: count the rows of all ranges
+//! in parallel (snapping nominal ones on the way), then prefix-sum. Index
+//! ranges already know theirs.
+static void NSVNumberRanges(ClientContext &ctx, const NSVBindData &bind,
+                            NSVGlobalState &state) {
+  auto &ranges = state.ranges;
+  if (ranges.empty() || ranges[0].first_row != DConstants::INVALID_INDEX) {
+    return;
+  }
+  vector<idx_t> counts(ranges.size());
+  TaskExecutor executor(ctx);
+  idx_t num_tasks = MinValue<idx_t>(
+      ranges.size(), TaskScheduler::GetScheduler(ctx).NumberOfThreads());
+  for (idx_t t = 0; t < num_tasks; t++) {
+    executor.ScheduleTask(make_uniq<NSVCountRangesTask>(
+        executor, BufferAllocator::Get(ctx), bind, state, counts,
+        t * ranges.size() / num_tasks, (t + 1) * ranges.size() / num_tasks));
+  }
+  executor.WorkOnTasks();
+
+  idx_t row = bind.skip_rows;
+  for (idx_t i = 0; i < ranges.size(); i++) {
+    ranges[i].first_row = row;
+    row += counts[i];
+  }
+}
+
+//! TABLESAMPLE SYSTEM (p%) pushed into the scan: keep each range with
+//! probability p, so the others are never read.
+static void NSVSampleRanges(const SampleOptions &options,
+                            NSVGlobalState &state) {
+  double keep = options.sample_size.GetValue<double>() / 100.0;
+  RandomEngine random(options.seed.IsValid()
+                          ? static_cast<int64_t>(options.seed.GetIndex())
+                          : -1);
+  vector<NSVScanRange> sampled;
+  for (auto &range : state.ranges) {
+    if (random.NextRandom() < keep) {
+      sampled.push_back(range);
+    }
+  }
+  state.ranges = std::move(sampled);
+}
+
+static unique_ptr<GlobalTableFunctionState>
+NSVInitGlobal(ClientContext &ctx, TableFunctionInitInput &input) {
+  auto state = make_uniq<NSVGlobalState>();
+  state->column_ids = input.column_ids;
+
+  auto &bind = input.bind_data->Cast<NSVBindData>();
+
+  // Build projection info for nsv_decode_columns.
+  state->col_indices.reserve(state->column_ids.size());
+  state->col_types.reserve(state->column_ids.size());
+  for (auto &cid : state->column_ids) {
+    if (cid == COLUMN_IDENTIFIER_EMPTY || cid == NSV_COLUMN_FILENAME ||
+        cid == NSV_COLUMN_FILE_ROW_NUMBER) {
+      state->row_numbers =
+          state->row_numbers || cid == NSV_COLUMN_FILE_ROW_NUMBER;
+      state->decoded_column.push_back(DConstants::INVALID_INDEX);
+      continue;
+    }
+    state->decoded_column.push_back(state->col_indices.size());
+    state->col_indices.push_back(static_cast<size_t>(cid));
+    state->col_types.push_back(bind.types[cid]);
+  }
+  state->count_only = state->col_indices.empty();
+  state->work_stealing =
+      !state->count_only && !state->row_numbers && !bind.async_handle;
+
+  auto &sample = input.extra_info.sample_options;
+  if (state->count_only && bind.index && !sample) {
+    auto &index = *bind.index;
+    state->indexed_rows =
+        index.row_count - MinValue(bind.skip_rows, index.row_count);
+    return std::move(state);
+  }
+
+  if (!bind.frames.empty()) {
+    NSVPlanFrameRanges(bind, *state);
+  } else if (bind.index) {
+    NSVPlanIndexRanges(ctx, bind, *state);
+  } else {
+    NSVPlanByteRanges(ctx, bind, *state);
+  }
+  if (state->row_numbers) {
+    NSVNumberRanges(ctx, bind, *state);
+  }
+  if (sample) {
+    NSVSampleRanges(*sample, *state);
+  }
+  state->scan_threads = MaxValue<idx_t>(
+      1, MinValue<idx_t>(state->ranges.size(),
+                         TaskScheduler::GetScheduler(ctx).NumberOfThreads()));
+  return std::move(state);
+}
+
+//! How direct_io reads, and the index blocks left out of the scan, for
+//! EXPLAIN ANALYZE.
+static InsertionOrderPreservingMap<string>
+NSVDynamicToString(TableFunctionDynamicToStringInput &input) {
+  InsertionOrderPreservingMap<string> result;
+  auto &bind = input.bind_data->Cast<NSVBindData>();
+  if (bind.direct_io && bind.direct_fd >= 0) {
+    result["Direct Reads"] = bind.o_direct ? "O_DIRECT" : "pread";
+  }
+  if (!bind.index || !input.global_state) {
+    return result;
+  }
+  auto &state = input.global_state->Cast<NSVGlobalState>();
+  result["Zone Pruned"] = to_string(state.zone_pruned_blocks);
+  if (!bind.index->bloom_filters.empty()) {
+    result["Bloom Pruned"] = to_string(state.bloom_pruned_blocks);
+  }
+  return result;
+}
+
+static unique_ptr<LocalTableFunctionState>
+NSVInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+             GlobalTableFunctionState *global_state) {
+  auto &gstate = global_state->Cast<NSVGlobalState>();
+  auto result = make_uniq<NSVLocalState>(BufferAllocator::Get(context.client));
+  if (input.bind_data->Cast<NSVBindData>().async_handle) {
+    result->reader.Initialize(context.client);
+  }
+  lock_guard<mutex> guard(gstate.workers_lock);
+  gstate.workers.push_back(make_uniq<NSVWorkerRange>());
+  result->worker = gstate.workers.back().get();
+  return std::move(result);
+}
+
+//! Zero the validity mask of `vec` (all rows NULL) and return it.
+static validity_t *NSVClearValidity(Vector &vec) {
+  auto &validity = FlatVector::Validity(vec);
+  if (!validity.GetData()) {
+    validity.Initialize(STANDARD_VECTOR_SIZE);
+  }
+  memset(validity.GetData(), 0,
+         ValidityMask::EntryCount(STANDARD_VECTOR_SIZE) * sizeof(validity_t));
+  return validity.GetData();
+}
+
+void NSVColumnDecoder::Initialize(Allocator &allocator_p,
+                                  const vector<LogicalType> &types_p) {
+  allocator = &allocator_p;
+  types = types_p;
+  dests.assign(types.size(), NsvColumnDest {});
+  targets.assign(types.size(), nullptr);
+  staging.clear();
+  staging.resize(types.size());
+  for (idx_t c = 0; c < types.size(); c++) {
+    auto &dest = dests[c];
+    if (types[c] == LogicalType::VARCHAR) {
+      dest.kind = NSV_DEST_VARCHAR;
+      dest.unescape = 1;
+      continue;
+    }
+    if (types[c] == LogicalType::BIGINT) {
+      dest.kind = NSV_DEST_BIGINT;
+    } else if (types[c] == LogicalType::DOUBLE) {
+      dest.kind = NSV_DEST_DOUBLE;
+    } else if (types[c] == LogicalType::BOOLEAN) {
+      dest.kind = NSV_DEST_BOOLEAN;
+    } else {
+      dest.kind = NSV_DEST_VARCHAR;
+    }
+    staging[c] = make_uniq<Vector>(LogicalType::VARCHAR);
+  }
+}
+
+void NSVColumnDecoder::Prepare() {
+  for (idx_t c = 0; c < dests.size(); c++) {
+    auto &dest = dests[c];
+    auto &target = *targets[c];
+    if (staging[c] && dest.kind == NSV_DEST_VARCHAR) {
+      dest.data = FlatVector::GetData(*staging[c]);
+      dest.validity = NSVClearValidity(*staging[c]);
+      continue;
+    }
+    dest.data = FlatVector::GetData(target);
+    dest.validity = NSVClearValidity(target);
+    if (staging[c]) {
+      dest.fallback = FlatVector::GetData(*staging[c]);
+      dest.fallback_mask = NSVClearValidity(*staging[c]);
+    }
+  }
+}
+
+//! Copy the cells of `cast` that were staged as fallbacks into `target`.
+template <class T>
+static void NSVMergeFallbacks(Vector &cast, const validity_t *fallbacks,
+                              idx_t count, Vector &target) {
+  auto src = FlatVector::GetData<T>(cast);
+  auto &src_validity = FlatVector::Validity(cast);
+  auto dst = FlatVector::GetData<T>(target);
+  auto &dst_validity = FlatVector::Validity(target);
+  for (idx_t i = 0; i < count; i++) {
+    if ((fallbacks[i / 64] >> (i % 64) & 1) && src_validity.RowIsValid(i)) {
+      dst[i] = src[i];
+      dst_validity.SetValid(i);
+    }
+  }
+}
+
+//! Unescaped bytes of a vector up to which its strings are copied out of the
+//! scratch buffer rather than taking the buffer over.
+static constexpr size_t NSV_SCRATCH_COPY_BYTES = 64 * 1024;
+
+//! Copy the strings of `target` that point into [begin, begin + len) into
+//! its own heap.
+static void NSVCopyStringsFrom(Vector &target, idx_t count,
+                               const uint8_t *begin, size_t len) {
+  auto strings = FlatVector::GetData<string_t>(target);
+  auto &validity = FlatVector::Validity(target);
+  auto first = const_char_ptr_cast(begin);
+  for (idx_t i = 0; i < count; i++) {
+    if (!validity.RowIsValid(i) || strings[i].IsInlined()) {
+      continue;
+    }
+    auto data = strings[i].GetData();
+    if (data >= first && data < first + len) {
+      strings[i] = StringVector::AddString(target, strings[i]);
+    }
+  }
+}
+
+void NSVColumnDecoder::Finish(ClientContext &ctx, const NSVBindData &bind,
+                              idx_t count, NsvScratchBuf *scratch,
+                              const uint8_t *input, size_t input_len,
+                              buffer_ptr<VectorBuffer> input_owner) {
+  for (idx_t c = 0; c < dests.size(); c++) {
+    if (!staging[c]) {
+      continue;
+    }
+    auto &dest = dests[c];
+    auto &target = *targets[c];
+    string error_msg;
+    bool cast_ok = true;
+    if (dest.kind == NSV_DEST_VARCHAR) {
+      cast_ok = VectorOperations::TryCast(ctx, *staging[c], target, count,
+                                          &error_msg, false);
+    } else {
+      auto fallbacks = dest.fallback_mask;
+      bool any = false;
+      for (idx_t w = 0; w < ValidityMask::EntryCount(count) && !any; w++) {
+        any = fallbacks[w] != 0;
+      }
+      if (!any) {
+        continue;
+      }
+      Vector cast(types[c], count);
+      cast_ok = VectorOperations::TryCast(ctx, *staging[c], cast, count,
+                                          &error_msg, false);
+      if (dest.kind == NSV_DEST_BIGINT) {
+        NSVMergeFallbacks<int64_t>(cast, fallbacks, count, target);
+      } else if (dest.kind == NSV_DEST_DOUBLE) {
+        NSVMergeFallbacks<double>(cast, fallbacks, count, target);
+      } else {
+        NSVMergeFallbacks<bool>(cast, fallbacks, count, target);
+      }
+    }
+    if (!cast_ok && bind.strict_cast) {
+      throw ConversionException("Error reading NSV file \"%s\": %s",
+                                bind.filename, error_msg);
+    }
+  }
+
+  // Strings of unescaped cells live in scratch. A few are copied into the
+  // vectors, so the scratch keeps its capacity for the next vector; beyond
+  // NSV_SCRATCH_COPY_BYTES the vectors take the scratch over instead. Large
+  // cells were unescaped into allocations of their own, each taken over by
+  // its column (or freed, if the column was staged and cast).
+  auto scratch_used = nsv_scratch_len(scratch);
+  bool copy_scratch =
+      scratch_used > 0 && scratch_used < NSV_SCRATCH_COPY_BYTES;
+  buffer_ptr<NSVStringOwner> scratch_owner;
+  size_t scratch_size = 0;
+  auto scratch_data =
+      copy_scratch ? nullptr : nsv_scratch_detach(scratch, &scratch_size);
+  if (scratch_data) {
+    scratch_owner = make_buffer<NSVStringOwner>();
+    scratch_owner->data = AllocatedData(*allocator, scratch_data, scratch_size);
+  }
+  size_t cell_size = 0;
+  size_t cell_col = 0;
+  while (auto cell = nsv_scratch_detach_large(scratch, &cell_size, &cell_col)) {
+    auto owner = make_buffer<NSVStringOwner>();
+    owner->data = AllocatedData(*allocator, cell, cell_size);
+    if (!staging[cell_col]) {
+      StringVector::AddBuffer(*targets[cell_col], std::move(owner));
+    }
+  }
+  for (idx_t c = 0; c < dests.size(); c++) {
+    if (staging[c] || dests[c].kind != NSV_DEST_VARCHAR) {
+      continue;
+    }
+    auto &target = *targets[c];
+    if (scratch_owner) {
+      StringVector::AddBuffer(target, scratch_owner);
+    } else if (copy_scratch) {
+      NSVCopyStringsFrom(target, count, nsv_scratch_ptr(scratch),
+                         scratch_used);
+    }
+    if (!input) {
+      continue;
+    }
+    if (input_owner) {
+      StringVector::AddBuffer(target, input_owner);
+      continue;
+    }
+    // The input is reused for the next range, or is the file mapping: copy
+    // what points into it.
+    NSVCopyStringsFrom(target, count, input, input_len);
+  }
+}
+
+//! madvise the whole pages within [start, end) of `buf`, if it is the file
+//! mapping (not a read buffer or an inflated frame).
+static void NSVAdviseRange(const NSVBindData &bind, const uint8_t *buf,
+                           size_t start, size_t end, int advice) {
+#ifndef _WIN32
+  if (!bind.mapping || buf != bind.file_data) {
+    return;
+  }
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t first = (start + page_size - 1) / page_size * page_size;
+  size_t last = end / page_size * page_size;
+  if (first < last) {
+    madvise(const_cast<uint8_t *>(buf) + first, last - first, advice);
+  }
+#endif
+}
+
+//! References a single bind holds on its mapping: the cache's, its own and
+//! its contents'.
+static constexpr long NSV_MAPPING_OWN_REFS = 3;
+
+//! Done with [start, end): let the kernel reclaim those pages first, so a
+//! big scan does not push everything else out of the page cache. Not while
+//! another query scans the same mapping, which may still need them.
+static void NSVReleaseRange(const NSVBindData &bind, const uint8_t *buf,
+                            size_t start, size_t end) {
+  if (bind.mapping.use_count() > NSV_MAPPING_OWN_REFS) {
+    return;
+  }
+#if defined(MADV_COLD)
+  NSVAdviseRange(bind, buf, start, end, MADV_COLD);
+#elif !defined(_WIN32)
+  NSVAdviseRange(bind, buf, start, end, MADV_DONTNEED);
+#endif
+}
+
+//! Claim the next range and point the local state at it. False once every
+//! range has been handed out.
+static bool NSVClaimRange(NSVGlobalState &gstate, NSVScanRange &range) {
+  idx_t range_idx = gstate.next_range.fetch_add(1);
+  if (range_idx >= static_cast<idx_t>(gstate.ranges.size())) {
+    return false;
+  }
+  range = gstate.ranges[range_idx];
+  return true;
+}
+
+//! io_mode='async' or direct_io: take the range read in the background (or
+//! read one now) and start reading the one after it. There is no work
+//! stealing here, so a thread reads ahead only while every scan thread can
+//! still get a range of its own: a tail range held for one thread's next
+//! call would leave another with nothing to do.
+static bool NSVClaimAsyncRange(const NSVBindData &bind, NSVGlobalState &gstate,
+                               NSVLocalState &lstate, NSVScanRange &range) {
+  if (lstate.reader.Pending()) {
+    lstate.reader.Wait();
+    range = lstate.prefetch_range;
+    std::swap(lstate.read_buffer, lstate.prefetch_buffer);
+  } else if (NSVClaimRange(gstate, range)) {
+    NSVReadRange(bind, gstate, range, lstate.read_buffer);
+  } else {
+    return false;
+  }
+  idx_t claimed = MinValue<idx_t>(gstate.next_range, gstate.ranges.size());
+  if (gstate.ranges.size() - claimed >= gstate.scan_threads &&
+      NSVClaimRange(gstate, lstate.prefetch_range)) {
+    lstate.reader.Start([&bind, &gstate, &lstate] {
+      NSVReadRange(bind, gstate, lstate.prefetch_range, lstate.prefetch_buffer);
+    });
+  }
+  return true;
+}
+
+static bool NSVNextRange(const NSVBindData &bind, NSVGlobalState &gstate,
+                         NSVLocalState &lstate) {
+  if (lstate.buf && lstate.range_start < lstate.range_end) {
+    NSVReleaseRange(bind, lstate.buf, lstate.range_start, lstate.range_end);
+    lstate.range_start = lstate.range_end;
+  }
+  NSVScanRange range;
+  do {
+    if (bind.async_handle) {
+      if (!NSVClaimAsyncRange(bind, gstate, lstate, range)) {
+        return false;
+      }
+      continue;
+    }
+    if (!NSVClaimRange(gstate, range)) {
+      return false;
+    }
+    if (range.nominal) {
+      NSVResolveRange(bind, gstate, range);
+    }
+  } while (range.start >= range.end);
+  if (bind.async_handle) {
+    lstate.buf = lstate.read_buffer.data();
+  } else if (range.frame != DConstants::INVALID_INDEX) {
+    NSVInflateFrame(bind, range.frame, lstate.frame_buffer);
+    lstate.buf = lstate.frame_buffer.data();
+  } else {
+    lstate.buf = bind.file_data;
+  }
+#ifndef _WIN32
+  // This range is needed right away; start reading in the next one to be
+  // handed out while it is decoded. Its bounds may still be nominal, which
+  // is close enough for whole pages.
+  idx_t next_idx = gstate.next_range;
+  if (next_idx < gstate.ranges.size()) {
+    auto &next = gstate.ranges[next_idx];
+    if (next.frame == DConstants::INVALID_INDEX) {
+      NSVAdviseRange(bind, bind.file_data, next.start, next.end,
+                     MADV_WILLNEED);
+    }
+  }
+#endif
+  lstate.range_start = range.start;
+  lstate.byte_pos = range.start;
+  lstate.range_end = range.end;
+  lstate.row_number = range.first_row;
+  lstate.exhausted = false;
+  lock_guard<mutex> guard(lstate.worker->lock);
+  lstate.worker->pos = range.start;
+  lstate.worker->end = range.end;
+  lstate.worker->stealable =
+      gstate.work_stealing && range.frame == DConstants::INVALID_INDEX;
+  return true;
+}
+
+//! Least undecoded bytes worth splitting off another thread's range.
+static constexpr size_t NSV_MIN_STEAL_BYTES = 256 * 1024;
+
+//! Once every planned range is handed out, take the back half of the range
+//! with the most bytes left, from the first row boundary past its midpoint.
+//! A slow range (say, one full of multi-megabyte cells) is then shared
+//! instead of being finished by one thread while the others idle.
+//!
+//! The split point is searched without holding any lock (a boundary can be
+//! far away); the victim is re-checked before its range is cut.
+static bool NSVStealRange(const NSVBindData &bind, NSVGlobalState &gstate,
+                          NSVLocalState &lstate) {
+  if (!gstate.work_stealing) {
+    return false;
+  }
+  NSVWorkerRange *victim = nullptr;
+  size_t victim_pos = 0;
+  size_t victim_end = 0;
+  {
+    lock_guard<mutex> guard(gstate.workers_lock);
+    size_t most = NSV_MIN_STEAL_BYTES;
+    for (auto &worker : gstate.workers) {
+      if (worker.get() == lstate.worker) {
+        continue;
+      }
+      lock_guard<mutex> worker_guard(worker->lock);
+      if (worker->stealable && worker->end - worker->pos > most) {
+        most = worker->end - worker->pos;
+        victim = worker.get();
+        victim_pos = worker->pos;
+        victim_end = worker->end;
+      }
+    }
+  }
+  if (!victim) {
+    return false;
+  }
+
+  size_t mid = victim_pos + (victim_end - victim_pos) / 2;
+  size_t split = FindNextRowBoundary(bind.file_data, victim_end, mid);
+  if (split >= victim_end) {
+    return false;
+  }
+
+  // Meanwhile the victim may have decoded past the split, been stolen
+  // from, or moved on to another range. Workers live as long as gstate.
+  size_t end;
+  {
+    lock_guard<mutex> victim_guard(victim->lock);
+    if (!victim->stealable || victim->pos >= split || victim->end <= split) {
+      return false;
+    }
+    end = victim->end;
+    victim->end = split;
+  }
+
+  lstate.buf = bind.file_data;
+  lstate.range_start = split;
+  lstate.byte_pos = split;
+  lstate.range_end = end;
+  lstate.exhausted = false;
+  lock_guard<mutex> own_guard(lstate.worker->lock);
+  lstate.worker->pos = split;
+  lstate.worker->end = end;
+  lstate.worker->stealable = true;
+  return true;
+}
+
+//! Fill the virtual columns of `output` for `count` rows starting at
+//! file_row_number `first_row`.
+static void NSVFillVirtualColumns(const NSVBindData &bind,
+                                  const NSVGlobalState &gstate,
+                                  idx_t first_row, idx_t count,
+                                  DataChunk &output) {
+  for (idx_t out_col = 0; out_col < output.ColumnCount(); out_col++) {
+    auto cid = gstate.column_ids[out_col];
+    if (cid == NSV_COLUMN_FILENAME) {
+      output.data[out_col].Reference(Value(bind.filename));
+    } else if (cid == NSV_COLUMN_FILE_ROW_NUMBER) {
+      output.data[out_col].Sequence(static_cast<int64_t>(first_row), 1, count);
+    }
+  }
+}
+
+static void NSVScan(ClientContext &ctx, TableFunctionInput &input,
+                    DataChunk &output) {
+  auto &bind = input.bind_data->Cast<NSVBindData>();
+  auto &gstate = input.global_state->Cast<NSVGlobalState>();
+  auto &lstate = input.local_state->Cast<NSVLocalState>();
+
+  // COUNT(*) over an indexed file: hand out row counts, no decoding.
+  if (gstate.count_only && bind.index) {
+    idx_t claimed = gstate.indexed_rows_claimed.fetch_add(STANDARD_VECTOR_SIZE);
+    if (claimed >= gstate.indexed_rows) {
+      output.SetCardinality(0);
+      return;
+    }
+    auto count =
+        MinValue<idx_t>(STANDARD_VECTOR_SIZE, gstate.indexed_rows - claimed);
+    NSVFillVirtualColumns(bind, gstate, bind.skip_rows + claimed, count,
+                          output);
+    output.SetCardinality(count);
+    return;
+  }
+
+  // COUNT(*) without an index: count row boundaries per range, then emit
+  // cardinality-only chunks.
+  if (gstate.count_only) {
+    while (lstate.pending_rows == 0) {
+      if (!NSVNextRange(bind, gstate, lstate)) {
+        output.SetCardinality(0);
+        return;
+      }
+      lstate.pending_rows = nsv_count_rows(lstate.buf + lstate.byte_pos,
+                                           lstate.range_end - lstate.byte_pos);
+    }
+    auto count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, lstate.pending_rows);
+    lstate.pending_rows -= count;
+    NSVFillVirtualColumns(bind, gstate, lstate.row_number, count, output);
+    lstate.row_number += count;
+    output.SetCardinality(count);
+    return;
+  }
+
+  idx_t nc = static_cast<idx_t>(gstate.col_indices.size());
+  auto &decoder = lstate.decoder;
+  if (decoder.dests.empty()) {
+    decoder.Initialize(lstate.scratch_allocator.allocator, gstate.col_types);
+  }
+  for (idx_t out_col = 0; out_col < output.ColumnCount(); out_col++) {
+    auto col = gstate.decoded_column[out_col];
+    if (col != DConstants::INVALID_INDEX) {
+      decoder.targets[col] = &output.data[out_col];
+    }
+  }
+
+  // Decode the next vector straight into the output, grabbing ranges until
+  // we get data or run out.
+  idx_t count = 0;
+  while (count == 0) {
+    if ((lstate.exhausted || lstate.byte_pos >= lstate.range_end) &&
+        !NSVNextRange(bind, gstate, lstate) &&
+        !NSVStealRange(bind, gstate, lstate)) {
+      output.SetCardinality(0);
+      return;
+    }
+
+    nsv_scratch_reset(lstate.scratch);
+    decoder.Prepare();
+
+    // The range is held meanwhile, so no thief splits off bytes this call
+    // consumes.
+    {
+      lock_guard<mutex> guard(lstate.worker->lock);
+      lstate.range_end = lstate.worker->end;
+      size_t chunk_len = lstate.range_end - lstate.byte_pos;
+      size_t bytes_consumed = 0;
+      count = nsv_decode_columns(
+          lstate.buf + lstate.byte_pos, chunk_len, gstate.col_indices.data(),
+          nc, decoder.dests.data(), STANDARD_VECTOR_SIZE, lstate.scratch,
+          &bytes_consumed);
+      lstate.byte_pos += bytes_consumed;
+      lstate.worker->pos = lstate.byte_pos;
+    }
+    lstate.scratch_allocator.ThrowIfFailed();
+
+    // count == 0: range exhausted, loop to grab next range.
+    if (count == 0) {
+      lstate.exhausted = true;
+    }
+  }
+
+  // The next call starts decoding at byte_pos; get its first lines on the
+  // way while this vector is finished.
+  size_t ahead = lstate.range_end - lstate.byte_pos;
+  NSVPrefetch(lstate.buf + lstate.byte_pos,
+              MinValue(NSV_PREFETCH_BYTES, ahead));
+
+  // Strings into the file's contents or a range's read buffer keep it
+  // alive; inflated frames are reused, so strings into them are copied.
+  // So are strings into a mapping: it is shared through the cache and
+  // follows the file, so a later in-place rewrite would change them (and a
+  // truncate would fault on them) while a result still holds them.
+  buffer_ptr<VectorBuffer> input_owner;
+  if (lstate.buf == bind.file_data && !bind.mapping) {
+    input_owner = bind.contents;
+  } else if (lstate.buf == lstate.read_buffer.data()) {
+    input_owner = lstate.read_buffer.storage;
+  }
+  decoder.Finish(ctx, bind, count, lstate.scratch, lstate.buf,
+                 lstate.range_end, input_owner);
+  NSVFillVirtualColumns(bind, gstate, lstate.row_number, count, output);
+  lstate.row_number += count;
+  output.SetCardinality(count);
+}
+
+// ── COPY FROM ───────────────────────────────────────────────────────
+
+//! COPY tbl FROM 'x.nsv' (FORMAT nsv): the table supplies names and types,
+//! so nothing is sniffed and the read_nsv scan parses straight into them.
+static unique_ptr<FunctionData>
+NSVCopyFromBind(ClientContext &ctx, CopyFromFunctionBindInput &input,
+                vector<string> &expected_names,
+                vector<LogicalType> &expected_types) {
+  auto result = make_uniq<NSVBindData>();
+  result->filename = input.info.file_path;
+  result->names = expected_names;
+  result->types = expected_types;
+  result->strict_cast = true;
+
+  auto hdr_it = input.info.options.find("header");
+  if (hdr_it != input.info.options.end()) {
+    result->has_header = hdr_it->second[0].GetValue<bool>();
+  }
+
+  vector<uint8_t> frame_prefix;
+  NSVLoadFile(ctx, *result, frame_prefix);
+
+  auto *buf = result->file_data;
+  size_t buf_len = result->file_size;
+  if (!result->frames.empty()) {
+    buf = frame_prefix.data();
+    buf_len = frame_prefix.size();
+  }
+
+  // Only the first row is decoded, to check the column count.
+  size_t first_row_end = FindNextRowBoundary(buf, buf_len, 0);
+  SampleHandle *sample = nsv_decode_sample(buf, first_row_end, 1);
+  idx_t ncols = sample ? nsv_sample_col_count(sample, 0) : 0;
+  nsv_sample_free(sample);
+  if (ncols == 0) {
+    return std::move(result);
+  }
+  if (ncols != expected_types.size()) {
+    throw InvalidInputException(
+        "NSV file \"%s\" has %d columns, but the COPY target expects %d",
+        result->filename, ncols, expected_types.size());
+  }
+
+  NSVSetDataStart(*result, buf, buf_len);
+  NSVAttachIndex(ctx, *result);
+  return std::move(result);
+}
+
+// ── nsv_build_index ─────────────────────────────────────────────────
+
+//! Append the bloom hash of the VARCHAR form of every non-NULL value.
+static void NSVBloomHashVector(ClientContext &ctx, Vector &vec, idx_t count,
+                               vector<uint64_t> &hashes) {
+  Vector strings(LogicalType::VARCHAR, count);
+  if (vec.GetType() == LogicalType::VARCHAR) {
+    strings.Reference(vec);
+  } else {
+    VectorOperations::Cast(ctx, vec, strings, count);
+  }
+  auto data = FlatVector::GetData<string_t>(strings);
+  auto &validity = FlatVector::Validity(strings);
+  for (idx_t i = 0; i < count; i++) {
+    if (validity.RowIsValid(i)) {
+      hashes.push_back(NSVBloomHash(data[i].GetData(), data[i].GetSize()));
+    }
+  }
+}
+
+//! Decode every block of an indexed file, in the types read_nsv would sniff,
+//! and record per-column zone maps plus bloom filters of `bloom_columns`.
+static void NSVSummarizeBlocks(ClientContext &ctx, const NSVBindData &file,
+                               const vector<column_t> &bloom_columns,
+                               NSVIndex &index) {
+  idx_t ncols = file.types.size();
+  if (ncols == 0) {
+    return;
+  }
+  for (auto c : bloom_columns) {
+    NSVBloomFilter filter;
+    filter.column = c;
+    filter.type = file.types[c].ToString();
+    index.bloom_filters.push_back(std::move(filter));
+  }
+  vector<size_t> col_indices(ncols);
+  for (idx_t c = 0; c < ncols; c++) {
+    col_indices[c] = c;
+    index.column_types.push_back(file.types[c].ToString());
+  }
+  NSVScratchAllocator scratch_allocator(BufferAllocator::Get(ctx));
+  unique_ptr<NsvScratchBuf, void (*)(NsvScratchBuf *)> scratch(
+      nsv_scratch_new(&scratch_allocator.callbacks), nsv_scratch_free);
+  DataChunk chunk;
+  chunk.Initialize(Allocator::Get(ctx), file.types);
+  NSVColumnDecoder decoder;
+  decoder.Initialize(scratch_allocator.allocator, file.types);
+
+  for (idx_t b = 0; b < index.BlockCount(); b++) {
+    vector<NSVZoneBuilder> zones(ncols);
+    vector<vector<uint64_t>> hashes(bloom_columns.size());
+    size_t pos = index.row_offsets[b];
+    size_t end = index.BlockEnd(b);
+    while (pos < end) {
+      nsv_scratch_reset(scratch.get());
+      chunk.Reset();
+      for (idx_t c = 0; c < ncols; c++) {
+        decoder.targets[c] = &chunk.data[c];
+      }
+      decoder.Prepare();
+      size_t bytes_consumed = 0;
+      size_t decoded = nsv_decode_columns(
+          file.file_data + pos, end - pos, col_indices.data(), ncols,
+          decoder.dests.data(), STANDARD_VECTOR_SIZE, scratch.get(),
+          &bytes_consumed);
+      scratch_allocator.ThrowIfFailed();
+      if (decoded > 0) {
+        // The chunk is used up before the next decode: no need to copy.
+        decoder.Finish(ctx, file, decoded, scratch.get(), nullptr, 0,
+                       nullptr);
+        for (idx_t c = 0; c < ncols; c++) {
+          zones[c].Update(chunk.data[c], decoded);
+        }
+        for (idx_t f = 0; f < bloom_columns.size(); f++) {
+          NSVBloomHashVector(ctx, chunk.data[bloom_columns[f]], decoded,
+                             hashes[f]);
+        }
+      }
+      if (decoded == 0) {
+        break;
+      }
+      pos += bytes_consumed;
+    }
+    vector<NSVZone> block;
+    for (auto &zone : zones) {
+      block.push_back(zone.Finish());
+    }
+    index.zone_maps.push_back(std::move(block));
+    for (idx_t f = 0; f < bloom_columns.size(); f++) {
+      index.bloom_filters[f].blocks.push_back(
+          NSVBloomFilter::BuildBlock(hashes[f]));
+    }
+  }
+}
+
+//! Index `filename` as it is on disk now and write the sidecar next to
+//! `sidecar_for` (the same file, unless COPY is about to rename it).
+//! `bloom_columns` are names as read_nsv reports them.
+static unique_ptr<NSVIndex>
+NSVBuildIndexFile(ClientContext &ctx, const string &filename, bool has_header,
+                  const string &sidecar_for,
+                  const vector<string> &bloom_columns) {
+  NSVBindData file;
+  file.filename = filename;
+  file.has_header = has_header;
+  vector<uint8_t> frame_prefix;
+  NSVLoadFile(ctx, file, frame_prefix);
+  if (!file.frames.empty() || file.decompressed) {
+    throw InvalidInputException(
+        "Only uncompressed NSV files can be indexed: %s", filename);
+  }
+  vector<column_t> bloom_column_ids;
+  if (file.file_size > 0) {
+    if (!NSVApplySchema(ctx, file, frame_prefix, sidecar_for)) {
+      NSVSniff(ctx, file, frame_prefix);
+    }
+    for (auto &name : bloom_columns) {
+      idx_t c = 0;
+      while (c < file.names.size() &&
+             !StringUtil::CIEquals(file.names[c], name)) {
+        c++;
+      }
+      if (c == file.names.size()) {
+        throw InvalidInputException(
+            "Bloom filter column \"%s\" not found in NSV file %s", name,
+            filename);
+      }
+      bloom_column_ids.push_back(c);
+    }
+  }
+  auto index = NSVIndex::Build(file.file_data, file.file_size,
+                               file.data_start_offset, has_header);
+  index->file_mtime = file.file_mtime;
+  NSVSummarizeBlocks(ctx, file, bloom_column_ids, *index);
+  index->Write(FileSystem::GetFileSystem(ctx), sidecar_for);
+  return index;
+}
+
+struct NSVBuildIndexBindData : public TableFunctionData {
+  string filename;
+  bool has_header = true;
+  vector<string> bloom_columns;
+};
+
+struct NSVBuildIndexState : public GlobalTableFunctionState {
+  bool done = false;
+};
+
+static unique_ptr<FunctionData>
+NSVBuildIndexBind(ClientContext &, TableFunctionBindInput &input,
+                  vector<LogicalType> &return_types, vector<string> &names) {
+  auto result = make_uniq<NSVBuildIndexBindData>();
+  result->filename = input.inputs[0].GetValue<string>();
+  auto hdr_it = input.named_parameters.find("header");
+  if (hdr_it != input.named_parameters.end()) {
+    result->has_header = hdr_it->second.GetValue<bool>();
+  }
+  auto bloom_it = input.named_parameters.find("bloom_filter_columns");
+  if (bloom_it != input.named_parameters.end()) {
+    for (auto &column : ListValue::GetChildren(bloom_it->second)) {
+      result->bloom_columns.push_back(column.ToString());
+    }
+  }
+  names = {"index_file", "row_count"};
+  return_types = {LogicalType::VARCHAR, LogicalType::UBIGINT};
+  return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState>
+NSVBuildIndexInit(ClientContext &, TableFunctionInitInput &) {
+  return make_uniq<NSVBuildIndexState>();
+}
+
+static void NSVBuildIndexScan(ClientContext &ctx, TableFunctionInput &input,
+                              DataChunk &output) {
+  auto &bind = input.bind_data->Cast<NSVBuildIndexBindData>();
+  auto &state = input.global_state->Cast<NSVBuildIndexState>();
+  if (state.done) {
+    return;
+  }
+  state.done = true;
+  auto index = NSVBuildIndexFile(ctx, bind.filename, bind.has_header,
+                                 bind.filename, bind.bloom_columns);
+  output.SetValue(0, 0, Value(NSVIndex::SidecarPath(bind.filename)));
+  output.SetValue(1, 0, Value::UBIGINT(index->row_count));
+  output.SetCardinality(1);
+}
+
+// ── write_nsv (COPY TO) ────────────────────────────────────────────
+
+enum class NSVCompression : uint8_t {
+  NONE = NSV_COMPRESSION_NONE,
+  GZIP = NSV_COMPRESSION_GZIP,
+  ZSTD = NSV_COMPRESSION_ZSTD,
+  //! Decided per output file from its extension.
+  AUTO_DETECT
+};
+
+static NSVCompression NSVCompressionFromString(const string &str) {
+  auto lower = StringUtil::Lower(str);
+  if (lower == "none" || lower == "uncompressed") {
+    return NSVCompression::NONE;
+  } else if (lower == "gzip") {
+    return NSVCompression::GZIP;
+  } else if (lower == "zstd") {
+    return NSVCompression::ZSTD;
+  } else if (lower == "auto" || lower == "auto_detect") {
+    return NSVCompression::AUTO_DETECT;
+  }
+  throw BinderException(
+      "Unsupported COMPRESSION \"%s\" for NSV (expected none, gzip or zstd)",
+      str);
+}
+
+static NSVCompression NSVCompressionFromPath(const string &path) {
+  if (StringUtil::EndsWith(path, ".gz")) {
+    return NSVCompression::GZIP;
+  } else if (StringUtil::EndsWith(path, ".zst")) {
+    return NSVCompression::ZSTD;
+  }
+  return NSVCompression::NONE;
+}
+
+struct NSVWriteBindData : public TableFunctionData {
+  vector<string> names;
+  vector<LogicalType> types;
+  bool write_header = true;
+  NSVCompression compression = NSVCompression::AUTO_DETECT;
+  //! Write a .nsvidx sidecar next to every output file.
+  bool write_index = false;
+  //! Columns to keep bloom filters for, named as read_nsv will see them.
+  vector<string> bloom_columns;
+  //! Write a .nsvschema sidecar with the exact column types.
+  bool write_schema = false;
+  //! Target path as given to COPY.
+  string file_path;
+};
+
+//! Uncompressed bytes per independently compressed block (one gzip member or
+//! zstd frame). Blocks always end on a row boundary.
+static constexpr idx_t NSV_COMPRESSION_BLOCK_SIZE = 2 * 1024 * 1024;
+
+//! Gathers encoded rows into blocks and compresses each block on its own, so
+//! blocks produced on different threads can be concatenated in any order
+//! that respects row order.
+struct NSVBlockEncoder {
+  explicit NSVBlockEncoder(NSVCompression compression)
+      : compression(compression) {}
+
+  NSVCompression compression;
+  //! Encoded rows not yet compressed.
+  vector<uint8_t> pending;
+  //! Bytes ready to be appended to the file.
+  vector<uint8_t> output;
+  //! (compressed, uncompressed) size of each block in `output`.
+  vector<pair<size_t, size_t>> blocks;
+
+  void Append(const uint8_t *data, size_t len) {
+    if (compression == NSVCompression::NONE) {
+      output.insert(output.end(), data, data + len);
+      return;
+    }
+    pending.insert(pending.end(), data, data + len);
+    if (pending.size() >= NSV_COMPRESSION_BLOCK_SIZE) {
+      FinishBlock();
+    }
+  }
+
+  void FinishBlock() {
+    if (pending.empty()) {
+      return;
     }
-    state.header_written = true;
+    auto out_len = NSVCompressBlock(static_cast<int>(compression),
+                                    pending.data(), pending.size(), output);
+    blocks.emplace_back(out_len, pending.size());
+    pending.clear();
   }
+};
+
+//! Encoded bytes are buffered per file and written in blocks of up to this
+//! size; an append as large as a block goes straight to the file.
+static constexpr idx_t NSV_WRITE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+struct NSVWriteGlobalState : public GlobalFunctionData {
+  string filename;
+  NSVCompression compression = NSVCompression::NONE;
+  //! Opened on the first flush, so partitions that never fill a block cost
+  //! one open + one write at finalize.
+  unique_ptr<FileHandle> file_handle;
+  //! Encoded bytes not yet written to the file. The buffer comes from the
+  //! buffer allocator (so every open file's counts toward memory_limit) on
+  //! the first append, and is given back once the file is finalized.
+  Allocator *allocator = nullptr;
+  AllocatedData write_buffer;
+  idx_t write_buffer_len = 0;
+  //! Compressed block sizes in file order, for the zstd seek table.
+  vector<size_t> block_sizes;
+  vector<size_t> block_uncompressed_sizes;
+  //! Serializes writes when several threads sink into the same file.
+  mutex lock;
+  //! Total for this file, used for FILE_SIZE_BYTES rotation.
+  std::atomic<idx_t> bytes_written{0};
+};
+
+struct NSVWriteLocalState : public LocalFunctionData {
+  //! Only used for compressed output; created on the first sink.
+  unique_ptr<NSVBlockEncoder> encoder;
+};
 
+struct NSVWriteBatchData : public PreparedBatchData {
+  explicit NSVWriteBatchData(NSVCompression compression)
+      : encoder(compression) {}
+
+  NSVBlockEncoder encoder;
+  idx_t row_count = 0;
+};
+
+//! Encode a single row of cells (the header) into an owned buffer.
+static void NSVEncodeHeader(const vector<string> &names, uint8_t *&out,
+                            size_t &out_len) {
+  NsvEncoder *enc = nsv_encoder_new();
+  for (auto &name : names) {
+    nsv_encoder_push_cell(enc, reinterpret_cast<const uint8_t *>(name.data()),
+                          name.size());
+  }
+  nsv_encoder_end_row(enc);
+  nsv_encoder_finish(enc, &out, &out_len);
+}
+
+//! Encode a chunk into an owned buffer (free with nsv_free_buf). Every row
+//! is terminated, so buffers can be concatenated at any chunk boundary.
+static void NSVEncodeChunk(ClientContext &ctx, const NSVWriteBindData &bind,
+                           DataChunk &input, uint8_t *&out, size_t &out_len) {
   idx_t count = input.size();
   idx_t ncols = input.ColumnCount();
 
@@ -535,7 +2422,7 @@ static void NSVWriteSink(ExecutionContext &context, FunctionData &bind_data,
       cast_vectors.emplace_back(LogicalType::VARCHAR); // placeholder
     } else {
       Vector target(LogicalType::VARCHAR, count);
-      VectorOperations::Cast(context.client, input.data[col], target, count);
+      VectorOperations::Cast(ctx, input.data[col], target, count);
       cast_vectors.push_back(std::move(target));
     }
   }
@@ -567,21 +2454,349 @@ static void NSVWriteSink(ExecutionContext &context, FunctionData &bind_data,
     }
   }
 
-  uint8_t *out = nullptr;
-  size_t out_len = 0;
+  out = nullptr;
+  out_len = 0;
   nsv_write_chunk(cell_ptrs.data(), cell_lens.data(), null_masks.data(), count,
                   ncols, &out, &out_len);
-  if (out && out_len > 0) {
-    fs.Write(*state.file_handle, (void *)out, out_len);
+}
+
+//! Write out the pending block, opening the file if needed. Caller holds
+//! the state lock.
+static void NSVFlushWriteBuffer(FileSystem &fs, NSVWriteGlobalState &state) {
+  if (!state.file_handle) {
+    state.file_handle =
+        fs.OpenFile(state.filename, FileFlags::FILE_FLAGS_WRITE |
+                                        FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+  }
+  if (state.write_buffer_len > 0) {
+    fs.Write(*state.file_handle, state.write_buffer.get(),
+             state.write_buffer_len);
+    state.write_buffer_len = 0;
+  }
+}
+
+//! Append output bytes to the file. Caller holds the state lock.
+static void NSVAppendLocked(FileSystem &fs, NSVWriteGlobalState &state,
+                            const uint8_t *buf, size_t len) {
+  state.bytes_written += len;
+  if (state.write_buffer_len + len > NSV_WRITE_BUFFER_SIZE) {
+    NSVFlushWriteBuffer(fs, state);
+    if (len >= NSV_WRITE_BUFFER_SIZE) {
+      fs.Write(*state.file_handle, (void *)buf, len);
+      return;
+    }
+  }
+  if (!state.write_buffer.get()) {
+    state.write_buffer = state.allocator->Allocate(NSV_WRITE_BUFFER_SIZE);
+  }
+  memcpy(state.write_buffer.get() + state.write_buffer_len, buf, len);
+  state.write_buffer_len += len;
+}
+
+//! Append output bytes to the file.
+static void NSVWriteBuffer(FileSystem &fs, NSVWriteGlobalState &state,
+                           const uint8_t *buf, size_t len) {
+  if (!buf || len == 0) {
+    return;
+  }
+  lock_guard<mutex> guard(state.lock);
+  NSVAppendLocked(fs, state, buf, len);
+}
+
+//! Write out whatever the encoder has ready, keeping its block sizes in step
+//! with the file.
+static void NSVWriteEncoderOutput(FileSystem &fs, NSVWriteGlobalState &state,
+                                  NSVBlockEncoder &encoder) {
+  if (encoder.output.empty()) {
+    return;
+  }
+  {
+    lock_guard<mutex> guard(state.lock);
+    NSVAppendLocked(fs, state, encoder.output.data(), encoder.output.size());
+    for (auto &block : encoder.blocks) {
+      state.block_sizes.push_back(block.first);
+      state.block_uncompressed_sizes.push_back(block.second);
+    }
+  }
+  encoder.output.clear();
+  encoder.blocks.clear();
+}
+
+static unique_ptr<FunctionData> NSVWriteBind(ClientContext &,
+                                             CopyFunctionBindInput &input,
+                                             const vector<string> &names,
+                                             const vector<LogicalType> &types) {
+  auto result = make_uniq<NSVWriteBindData>();
+  result->names = names;
+  result->types = types;
+
+  auto it = input.info.options.find("header");
+  if (it != input.info.options.end()) {
+    result->write_header = it->second[0].GetValue<bool>();
+  }
+
+  auto comp_it = input.info.options.find("compression");
+  if (comp_it != input.info.options.end()) {
+    result->compression =
+        NSVCompressionFromString(comp_it->second[0].ToString());
+  }
+
+  result->file_path = input.info.file_path;
+  auto index_it = input.info.options.find("index");
+  if (index_it != input.info.options.end()) {
+    result->write_index = index_it->second.empty() ||
+                          index_it->second[0].GetValue<bool>();
+  }
+
+  // Bloom filters live in the index, so asking for them implies INDEX.
+  auto bloom_it = input.info.options.find("bloom_filter_columns");
+  if (bloom_it != input.info.options.end()) {
+    for (auto &option : bloom_it->second) {
+      auto entries = option.type().id() == LogicalTypeId::LIST
+                         ? ListValue::GetChildren(option)
+                         : vector<Value> {option};
+      for (auto &entry : entries) {
+        auto name = entry.ToString();
+        idx_t c = 0;
+        while (c < names.size() && !StringUtil::CIEquals(names[c], name)) {
+          c++;
+        }
+        if (c == names.size()) {
+          throw BinderException(
+              "BLOOM_FILTER_COLUMNS: column \"%s\" is not being written",
+              name);
+        }
+        // Without a header read_nsv names columns column0, column1, ...
+        result->bloom_columns.push_back(
+            result->write_header ? names[c] : "column" + to_string(c));
+      }
+    }
+    result->write_index = true;
+  }
+
+  auto schema_it = input.info.options.find("schema");
+  if (schema_it != input.info.options.end()) {
+    result->write_schema = schema_it->second.empty() ||
+                           schema_it->second[0].GetValue<bool>();
+  }
+
+  if (result->write_index) {
+    auto compression = result->compression == NSVCompression::AUTO_DETECT
+                           ? NSVCompressionFromPath(result->file_path)
+                           : result->compression;
+    if (compression != NSVCompression::NONE) {
+      throw BinderException("INDEX is only supported for uncompressed NSV");
+    }
+  }
+
+  // Files can only be rotated between chunks of up to 2048 rows, so a row
+  // limit could not be kept.
+  if (input.info.options.find("rows_per_file") != input.info.options.end()) {
+    throw BinderException(
+        "ROWS_PER_FILE is not supported for FORMAT nsv; use FILE_SIZE_BYTES");
+  }
+
+  return std::move(result);
+}
+
+static unique_ptr<GlobalFunctionData>
+NSVWriteInitGlobal(ClientContext &ctx, FunctionData &bind_data,
+                   const string &filename) {
+  auto &bind = bind_data.Cast<NSVWriteBindData>();
+  auto result = make_uniq<NSVWriteGlobalState>();
+  result->filename = filename;
+  result->allocator = &BufferAllocator::Get(ctx);
+  result->compression = bind.compression == NSVCompression::AUTO_DETECT
+                            ? NSVCompressionFromPath(filename)
+                            : bind.compression;
+  auto &fs = FileSystem::GetFileSystem(ctx);
+
+  // Every file (including rotated and per-thread ones) gets its own header,
+  // compressed as a block of its own.
+  if (bind.write_header) {
+    uint8_t *hdr = nullptr;
+    size_t hdr_len = 0;
+    NSVEncodeHeader(bind.names, hdr, hdr_len);
+    NSVBlockEncoder encoder(result->compression);
+    encoder.Append(hdr, hdr_len);
+    encoder.FinishBlock();
+    NSVWriteEncoderOutput(fs, *result, encoder);
+    if (hdr) {
+      nsv_free_buf(hdr, hdr_len);
+    }
+  }
+  return std::move(result);
+}
+
+static unique_ptr<LocalFunctionData> NSVWriteInitLocal(ExecutionContext &,
+                                                       FunctionData &) {
+  return make_uniq<NSVWriteLocalState>();
+}
+
+static void NSVWriteSink(ExecutionContext &context, FunctionData &bind_data,
+                         GlobalFunctionData &gstate, LocalFunctionData &lstate,
+                         DataChunk &input) {
+  auto &bind = bind_data.Cast<NSVWriteBindData>();
+  auto &state = gstate.Cast<NSVWriteGlobalState>();
+  auto &local = lstate.Cast<NSVWriteLocalState>();
+  auto &fs = FileSystem::GetFileSystem(context.client);
+
+  // Encode (and compress) outside the lock; parallel sinks only serialize on
+  // the write.
+  uint8_t *out = nullptr;
+  size_t out_len = 0;
+  NSVEncodeChunk(context.client, bind, input, out, out_len);
+  if (state.compression == NSVCompression::NONE) {
+    NSVWriteBuffer(fs, state, out, out_len);
+  } else {
+    if (!local.encoder) {
+      local.encoder = make_uniq<NSVBlockEncoder>(state.compression);
+    }
+    local.encoder->Append(out, out_len);
+    NSVWriteEncoderOutput(fs, state, *local.encoder);
+  }
+  if (out) {
     nsv_free_buf(out, out_len);
   }
 }
 
-static void NSVWriteCombine(ExecutionContext &, FunctionData &,
-                            GlobalFunctionData &, LocalFunctionData &) {}
+static void NSVWriteCombine(ExecutionContext &context, FunctionData &,
+                            GlobalFunctionData &gstate,
+                            LocalFunctionData &lstate) {
+  auto &state = gstate.Cast<NSVWriteGlobalState>();
+  auto &local = lstate.Cast<NSVWriteLocalState>();
+  if (local.encoder) {
+    local.encoder->FinishBlock();
+    NSVWriteEncoderOutput(FileSystem::GetFileSystem(context.client), state,
+                          *local.encoder);
+  }
+}
+
+//! Runs on worker threads: encodes and compresses a whole batch so that
+//! only the ordered append happens in NSVWriteFlushBatch.
+static unique_ptr<PreparedBatchData>
+NSVWritePrepareBatch(ClientContext &ctx, FunctionData &bind_data,
+                     GlobalFunctionData &gstate,
+                     unique_ptr<ColumnDataCollection> collection) {
+  auto &bind = bind_data.Cast<NSVWriteBindData>();
+  auto &state = gstate.Cast<NSVWriteGlobalState>();
+  auto batch = make_uniq<NSVWriteBatchData>(state.compression);
+  for (auto &chunk : collection->Chunks()) {
+    uint8_t *out = nullptr;
+    size_t out_len = 0;
+    NSVEncodeChunk(ctx, bind, chunk, out, out_len);
+    if (out) {
+      batch->encoder.Append(out, out_len);
+      nsv_free_buf(out, out_len);
+    }
+    batch->row_count += chunk.size();
+  }
+  batch->encoder.FinishBlock();
+  return std::move(batch);
+}
+
+static void NSVWriteFlushBatch(ClientContext &ctx, FunctionData &,
+                               GlobalFunctionData &gstate,
+                               PreparedBatchData &batch_data) {
+  auto &state = gstate.Cast<NSVWriteGlobalState>();
+  auto &batch = batch_data.Cast<NSVWriteBatchData>();
+  NSVWriteEncoderOutput(FileSystem::GetFileSystem(ctx), state, batch.encoder);
+}
 
-static void NSVWriteFinalize(ClientContext &, FunctionData &,
-                             GlobalFunctionData &) {}
+//! Name the sidecars of the written file `filename` are stored under. COPY
+//! writes either the target it was given, files inside it (a directory), or
+//! a temporary stand-in next to it that it renames to the target once the
+//! copy succeeds; the stand-in's sidecars belong to the target (renaming
+//! keeps size and mtime).
+static string NSVSidecarTarget(FileSystem &fs, const NSVWriteBindData &bind,
+                               const string &filename) {
+  auto &target = bind.file_path;
+  auto separator = fs.PathSeparator(target);
+  auto dir_prefix = StringUtil::EndsWith(target, separator)
+                        ? target
+                        : target + separator;
+  if (filename == target || StringUtil::StartsWith(filename, dir_prefix)) {
+    return filename;
+  }
+  return target;
+}
+
+static void NSVWriteFinalize(ClientContext &ctx, FunctionData &bind_data,
+                             GlobalFunctionData &gstate) {
+  auto &bind = bind_data.Cast<NSVWriteBindData>();
+  auto &state = gstate.Cast<NSVWriteGlobalState>();
+  auto &fs = FileSystem::GetFileSystem(ctx);
+  lock_guard<mutex> guard(state.lock);
+  // zstd output ends in a seek table so read_nsv can scan frames in parallel.
+  if (state.compression == NSVCompression::ZSTD) {
+    uint8_t *trailer = nullptr;
+    size_t trailer_len = 0;
+    if (nsv_zstd_seek_table(state.block_sizes.data(),
+                            state.block_uncompressed_sizes.data(),
+                            state.block_sizes.size(), &trailer,
+                            &trailer_len) == 0) {
+      NSVAppendLocked(fs, state, trailer, trailer_len);
+      nsv_free_buf(trailer, trailer_len);
+    }
+  }
+  NSVFlushWriteBuffer(fs, state);
+  state.write_buffer.Reset();
+  state.file_handle->Close();
+
+  auto sidecar_for = NSVSidecarTarget(fs, bind, state.filename);
+  // The schema goes first, so the index is built with the same types.
+  if (bind.write_schema) {
+    auto handle = fs.OpenFile(state.filename, FileFlags::FILE_FLAGS_READ);
+    NSVSchema schema;
+    schema.file_size = fs.GetFileSize(*handle);
+    schema.file_mtime = NSVFileMtime(fs, *handle, state.filename);
+    schema.has_header = bind.write_header;
+    for (idx_t c = 0; c < bind.names.size(); c++) {
+      schema.names.push_back(bind.write_header ? bind.names[c]
+                                               : "column" + to_string(c));
+      schema.types.push_back(bind.types[c].ToString());
+    }
+    schema.Write(fs, sidecar_for);
+  }
+  if (bind.write_index) {
+    NSVBuildIndexFile(ctx, state.filename, bind.write_header, sidecar_for,
+                      bind.bloom_columns);
+  }
+}
+
+static CopyFunctionExecutionMode
+NSVWriteExecutionMode(bool preserve_insertion_order,
+                      bool supports_batch_index) {
+  // Chunks encode to whole rows, so without an ordering requirement every
+  // thread can append to the same file.
+  if (!preserve_insertion_order) {
+    return CopyFunctionExecutionMode::PARALLEL_COPY_TO_FILE;
+  }
+  if (!supports_batch_index) {
+    return CopyFunctionExecutionMode::REGULAR_COPY_TO_FILE;
+  }
+  // Batches are encoded and compressed in parallel, then appended in order.
+  return CopyFunctionExecutionMode::BATCH_COPY_TO_FILE;
+}
+
+static idx_t NSVWriteFileSize(GlobalFunctionData &gstate) {
+  return gstate.Cast<NSVWriteGlobalState>().bytes_written;
+}
+
+static bool NSVWriteRotateFiles(FunctionData &,
+                                const optional_idx &file_size_bytes) {
+  return file_size_bytes.IsValid();
+}
+
+//! Checked between sinks, so files are always cut at chunk (row) boundaries.
+//! The limit is therefore approximate: a file is closed once it has passed
+//! it, and holds up to a chunk more.
+static bool NSVWriteRotateNextFile(GlobalFunctionData &gstate, FunctionData &,
+                                   const optional_idx &file_size_bytes) {
+  auto &state = gstate.Cast<NSVWriteGlobalState>();
+  return file_size_bytes.IsValid() &&
+         state.bytes_written > file_size_bytes.GetIndex();
+}
 
 // ── Extension registration ──────────────────────────────────────────
 
@@ -592,9 +2807,42 @@ static void LoadInternal(ExtensionLoader &loader) {
   read_nsv.init_local = NSVInitLocal;
   read_nsv.named_parameters["all_varchar"] = LogicalType::BOOLEAN;
   read_nsv.named_parameters["header"] = LogicalType::BOOLEAN;
+  read_nsv.named_parameters["skip"] = LogicalType::BIGINT;
+  read_nsv.named_parameters["io_mode"] = LogicalType::VARCHAR;
+  read_nsv.named_parameters["direct_io"] = LogicalType::BOOLEAN;
   read_nsv.projection_pushdown = true;
+  read_nsv.get_virtual_columns = NSVGetVirtualColumns;
+  read_nsv.pushdown_complex_filter = NSVPushdownComplexFilter;
+  read_nsv.statistics = NSVStatistics;
+  read_nsv.dynamic_to_string = NSVDynamicToString;
+  read_nsv.sampling_pushdown = true;
   loader.RegisterFunction(read_nsv);
 
+  auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
+  config.AddExtensionOption(
+      "nsv_mmap_populate",
+      "Prefault the whole file when read_nsv maps it (MAP_POPULATE)",
+      LogicalType::BOOLEAN, Value::BOOLEAN(false));
+  config.AddExtensionOption(
+      "nsv_mmap_hugepages",
+      "Ask for transparent huge pages on read_nsv's file mapping",
+      LogicalType::BOOLEAN, Value::BOOLEAN(false));
+  // A cached mapping follows its file, so strings are copied out of it (see
+  // NSVScan); a file rewritten in place during a scan can still SIGBUS it.
+  config.AddExtensionOption(
+      "nsv_mmap_cache_idle_seconds",
+      "Seconds an unused read_nsv file mapping stays cached for reuse",
+      LogicalType::BIGINT, Value::BIGINT(60));
+
+  // nsv_build_index: write the .nsvidx sidecar for an existing file
+  TableFunction build_index("nsv_build_index", {LogicalType::VARCHAR},
+                            NSVBuildIndexScan, NSVBuildIndexBind,
+                            NSVBuildIndexInit);
+  build_index.named_parameters["header"] = LogicalType::BOOLEAN;
+  build_index.named_parameters["bloom_filter_columns"] =
+      LogicalType::LIST(LogicalType::VARCHAR);
+  loader.RegisterFunction(build_index);
+
   // COPY TO ... (FORMAT nsv)
   CopyFunction nsv_copy("nsv");
   nsv_copy.copy_to_bind = NSVWriteBind;
@@ -603,6 +2851,14 @@ static void LoadInternal(ExtensionLoader &loader) {
   nsv_copy.copy_to_sink = NSVWriteSink;
   nsv_copy.copy_to_combine = NSVWriteCombine;
   nsv_copy.copy_to_finalize = NSVWriteFinalize;
+  nsv_copy.execution_mode = NSVWriteExecutionMode;
+  nsv_copy.prepare_batch = NSVWritePrepareBatch;
+  nsv_copy.flush_batch = NSVWriteFlushBatch;
+  nsv_copy.file_size = NSVWriteFileSize;
+  nsv_copy.rotate_files = NSVWriteRotateFiles;
+  nsv_copy.rotate_next_file = NSVWriteRotateNextFile;
+  nsv_copy.copy_from_bind = NSVCopyFromBind;
+  nsv_copy.copy_from_function = read_nsv;
   nsv_copy.extension = "nsv";
   loader.RegisterFunction(nsv_copy);
 }
@@ -0,0 +1,624 @@
+#include "nsv_index.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/operator/comparison_operators.hpp"
+
+#include <cstring>
+
+namespace duckdb {
+
+static constexpr char NSV_INDEX_MAGIC[8] = {'N', 'S', 'V', 'I',
+                                            'D', 'X', '\0', '\1'};
+static constexpr char NSV_SCHEMA_MAGIC[8] = {'N', 'S', 'V', 'S',
+                                             'C', 'H', '\0', '\1'};
+
+//! Section tags; values are part of the file format.
+enum class NSVIndexSection : uint32_t {
+  ROW_OFFSETS = 1,
+  ZONE_MAPS = 2,
+  BLOOM_FILTERS = 3
+};
+
+// ── Row walking ─────────────────────────────────────────────────────
+
+size_t NSVSkipRows(const uint8_t *buf, size_t len, size_t from, idx_t &n) {
+  idx_t skipped = 0;
+  size_t pos = from;
+  size_t end = from;
+  bool row_has_cells = false;
+  while (skipped < n && pos < len) {
+    auto nl = static_cast<const uint8_t *>(memchr(buf + pos, '\n', len - pos));
+    if (!nl) {
+      // Trailing cell without a newline.
+      row_has_cells = true;
+      break;
+    }
+    size_t line_end = static_cast<size_t>(nl - buf);
+    if (line_end > pos) {
+      row_has_cells = true;
+    } else if (row_has_cells) {
+      skipped++;
+      end = line_end + 1;
+      row_has_cells = false;
+    }
+    pos = line_end + 1;
+  }
+  if (skipped < n && row_has_cells) {
+    skipped++;
+    end = len;
+  }
+  n = skipped;
+  return end;
+}
+
+unique_ptr<NSVIndex> NSVIndex::Build(const uint8_t *buf, idx_t len,
+                                     idx_t data_start, bool has_header,
+                                     idx_t row_stride) {
+  auto index = make_uniq<NSVIndex>();
+  index->file_size = len;
+  index->has_header = has_header;
+  index->data_start = data_start;
+  index->row_stride = row_stride;
+  size_t pos = data_start;
+  while (pos < len) {
+    idx_t rows = row_stride;
+    size_t next = NSVSkipRows(buf, len, pos, rows);
+    if (rows == 0) {
+      break;
+    }
+    index->row_offsets.push_back(pos);
+    index->row_count += rows;
+    pos = next;
+  }
+  return index;
+}
+
+// ── Zone maps ───────────────────────────────────────────────────────
+
+//! Positions of the smallest and largest valid value in a flat vector.
+template <class T>
+static void NSVMinMaxIndex(Vector &vec, idx_t count, idx_t &min_idx,
+                           idx_t &max_idx) {
+  auto data = FlatVector::GetData<T>(vec);
+  auto &validity = FlatVector::Validity(vec);
+  for (idx_t i = 0; i < count; i++) {
+    if (!validity.RowIsValid(i)) {
+      continue;
+    }
+    if (min_idx == DConstants::INVALID_INDEX ||
+        LessThan::Operation(data[i], data[min_idx])) {
+      min_idx = i;
+    }
+    if (max_idx == DConstants::INVALID_INDEX ||
+        GreaterThan::Operation(data[i], data[max_idx])) {
+      max_idx = i;
+    }
+  }
+}
+
+void NSVZoneBuilder::Update(Vector &vec, idx_t count) {
+  auto &validity = FlatVector::Validity(vec);
+  for (idx_t i = 0; i < count; i++) {
+    if (!validity.RowIsValid(i)) {
+      null_count++;
+    }
+  }
+  if (unsupported) {
+    return;
+  }
+
+  idx_t min_idx = DConstants::INVALID_INDEX;
+  idx_t max_idx = DConstants::INVALID_INDEX;
+  switch (vec.GetType().InternalType()) {
+  case PhysicalType::BOOL:
+    NSVMinMaxIndex<bool>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::INT8:
+    NSVMinMaxIndex<int8_t>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::INT16:
+    NSVMinMaxIndex<int16_t>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::INT32:
+    NSVMinMaxIndex<int32_t>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::INT64:
+    NSVMinMaxIndex<int64_t>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::INT128:
+    NSVMinMaxIndex<hugeint_t>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::UINT8:
+    NSVMinMaxIndex<uint8_t>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::UINT16:
+    NSVMinMaxIndex<uint16_t>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::UINT32:
+    NSVMinMaxIndex<uint32_t>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::UINT64:
+    NSVMinMaxIndex<uint64_t>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::FLOAT:
+    NSVMinMaxIndex<float>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::DOUBLE:
+    NSVMinMaxIndex<double>(vec, count, min_idx, max_idx);
+    break;
+  case PhysicalType::VARCHAR:
+    NSVMinMaxIndex<string_t>(vec, count, min_idx, max_idx);
+    break;
+  default:
+    unsupported = true;
+    return;
+  }
+  if (min_idx == DConstants::INVALID_INDEX) {
+    return;
+  }
+  auto lo = vec.GetValue(min_idx);
+  auto hi = vec.GetValue(max_idx);
+  if (min.IsNull() || lo < min) {
+    min = lo;
+  }
+  if (max.IsNull() || hi > max) {
+    max = hi;
+  }
+}
+
+NSVZone NSVZoneBuilder::Finish() const {
+  NSVZone zone;
+  zone.null_count = null_count;
+  if (unsupported || min.IsNull()) {
+    return zone;
+  }
+  auto lo = min.ToString();
+  auto hi = max.ToString();
+  if (lo.size() <= MAX_BOUND_SIZE && hi.size() <= MAX_BOUND_SIZE) {
+    zone.has_minmax = true;
+    zone.min = std::move(lo);
+    zone.max = std::move(hi);
+  }
+  return zone;
+}
+
+bool NSVZonePredicate::MayMatch(const NSVZone &zone, idx_t block_rows,
+                                const LogicalType &type) const {
+  // No comparison is true for NULL.
+  if (zone.null_count >= block_rows) {
+    return false;
+  }
+  Value min;
+  Value max;
+  if (!zone.has_minmax || !Value(zone.min).DefaultTryCastAs(type, min) ||
+      !Value(zone.max).DefaultTryCastAs(type, max)) {
+    return true;
+  }
+  auto &constant = constants[0];
+  switch (comparison) {
+  case ExpressionType::COMPARE_EQUAL:
+    return !(constant < min) && !(constant > max);
+  case ExpressionType::COMPARE_IN:
+    for (auto &value : constants) {
+      if (!(value < min) && !(value > max)) {
+        return true;
+      }
+    }
+    return false;
+  case ExpressionType::COMPARE_GREATERTHAN:
+    return max > constant;
+  case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+    return max >= constant;
+  case ExpressionType::COMPARE_LESSTHAN:
+    return min < constant;
+  case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+    return min <= constant;
+  default:
+    return true;
+  }
+}
+
+// ── Bloom filters ───────────────────────────────────────────────────
+
+uint64_t NSVBloomHash(const char *data, idx_t len) {
+  // FNV-1a, then the murmur3 finalizer to spread the bits.
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (idx_t i = 0; i < len; i++) {
+    h ^= static_cast<uint8_t>(data[i]);
+    h *= 0x100000001b3ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+//! Bit positions of a hash: double hashing over `nbits`.
+template <class F>
+static void NSVBloomProbes(uint64_t hash, idx_t nbits, F &&probe) {
+  uint64_t h1 = hash;
+  uint64_t h2 = (hash >> 32) | 1;
+  for (idx_t i = 0; i < NSVBloomFilter::NUM_PROBES; i++) {
+    probe((h1 + i * h2) % nbits);
+  }
+}
+
+vector<uint64_t> NSVBloomFilter::BuildBlock(const vector<uint64_t> &hashes) {
+  if (hashes.empty()) {
+    return {};
+  }
+  idx_t nwords = (hashes.size() * BITS_PER_VALUE + 63) / 64;
+  vector<uint64_t> bits(nwords, 0);
+  for (auto hash : hashes) {
+    NSVBloomProbes(hash, nwords * 64, [&](idx_t bit) {
+      bits[bit / 64] |= uint64_t(1) << (bit % 64);
+    });
+  }
+  return bits;
+}
+
+bool NSVBloomFilter::MayContainAny(idx_t b,
+                                   const vector<uint64_t> &hashes) const {
+  auto &bits = blocks[b];
+  if (bits.empty()) {
+    return false;
+  }
+  for (auto hash : hashes) {
+    bool found = true;
+    NSVBloomProbes(hash, bits.size() * 64, [&](idx_t bit) {
+      found = found && (bits[bit / 64] & (uint64_t(1) << (bit % 64)));
+    });
+    if (found) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// ── Serialization ───────────────────────────────────────────────────
+
+static void NSVPutU32(string &out, uint32_t v) {
+  for (idx_t i = 0; i < 4; i++) {
+    out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+  }
+}
+
+static void NSVPutU64(string &out, uint64_t v) {
+  for (idx_t i = 0; i < 8; i++) {
+    out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+  }
+}
+
+static void NSVPutString(string &out, const string &str) {
+  NSVPutU64(out, str.size());
+  out += str;
+}
+
+static void NSVPutSection(string &out, NSVIndexSection tag,
+                          const string &payload) {
+  NSVPutU32(out, static_cast<uint32_t>(tag));
+  NSVPutU64(out, payload.size());
+  out += payload;
+}
+
+//! Bounds-checked little-endian reader; `ok` drops to false on overrun.
+struct NSVIndexReader {
+  NSVIndexReader(const string &data, idx_t pos, idx_t end)
+      : data(data), pos(pos), end(end) {}
+
+  const string &data;
+  idx_t pos;
+  idx_t end;
+  bool ok = true;
+
+  uint64_t Get(idx_t width) {
+    if (!ok || end - pos < width) {
+      ok = false;
+      return 0;
+    }
+    uint64_t v = 0;
+    for (idx_t i = 0; i < width; i++) {
+      auto byte = static_cast<uint8_t>(data[pos + i]);
+      v |= static_cast<uint64_t>(byte) << (8 * i);
+    }
+    pos += width;
+    return v;
+  }
+  uint32_t U32() { return static_cast<uint32_t>(Get(4)); }
+  uint64_t U64() { return Get(8); }
+  string String() {
+    auto len = U64();
+    if (!ok || end - pos < len) {
+      ok = false;
+      return string();
+    }
+    string result = data.substr(pos, len);
+    pos += len;
+    return result;
+  }
+};
+
+string NSVIndex::Serialize() const {
+  string out(NSV_INDEX_MAGIC, sizeof(NSV_INDEX_MAGIC));
+  NSVPutU64(out, file_size);
+  NSVPutU64(out, static_cast<uint64_t>(file_mtime));
+  NSVPutU64(out, has_header ? 1 : 0);
+  NSVPutU64(out, data_start);
+
+  string rows;
+  NSVPutU64(rows, row_stride);
+  NSVPutU64(rows, row_count);
+  NSVPutU64(rows, row_offsets.size());
+  for (auto offset : row_offsets) {
+    NSVPutU64(rows, offset);
+  }
+  NSVPutSection(out, NSVIndexSection::ROW_OFFSETS, rows);
+
+  if (!zone_maps.empty()) {
+    string zones;
+    NSVPutU64(zones, column_types.size());
+    for (auto &type : column_types) {
+      NSVPutString(zones, type);
+    }
+    NSVPutU64(zones, zone_maps.size());
+    for (auto &block : zone_maps) {
+      for (auto &zone : block) {
+        NSVPutU64(zones, zone.null_count);
+        NSVPutU64(zones, zone.has_minmax ? 1 : 0);
+        if (zone.has_minmax) {
+          NSVPutString(zones, zone.min);
+          NSVPutString(zones, zone.max);
+        }
+      }
+    }
+    NSVPutSection(out, NSVIndexSection::ZONE_MAPS, zones);
+  }
+
+  if (!bloom_filters.empty()) {
+    string blooms;
+    NSVPutU64(blooms, bloom_filters.size());
+    for (auto &filter : bloom_filters) {
+      NSVPutU64(blooms, filter.column);
+      NSVPutString(blooms, filter.type);
+      NSVPutU64(blooms, filter.blocks.size());
+      for (auto &bits : filter.blocks) {
+        NSVPutU64(blooms, bits.size());
+        for (auto word : bits) {
+          NSVPutU64(blooms, word);
+        }
+      }
+    }
+    NSVPutSection(out, NSVIndexSection::BLOOM_FILTERS, blooms);
+  }
+  return out;
+}
+
+unique_ptr<NSVIndex> NSVIndex::Deserialize(const string &data) {
+  if (data.size() < sizeof(NSV_INDEX_MAGIC) ||
+      memcmp(data.data(), NSV_INDEX_MAGIC, sizeof(NSV_INDEX_MAGIC)) != 0) {
+    return nullptr;
+  }
+  NSVIndexReader header(data, sizeof(NSV_INDEX_MAGIC), data.size());
+  auto index = make_uniq<NSVIndex>();
+  index->file_size = header.U64();
+  index->file_mtime = static_cast<int64_t>(header.U64());
+  index->has_header = (header.U64() & 1) != 0;
+  index->data_start = header.U64();
+  if (!header.ok) {
+    return nullptr;
+  }
+
+  bool has_rows = false;
+  idx_t pos = header.pos;
+  while (pos < data.size()) {
+    NSVIndexReader section(data, pos, data.size());
+    auto tag = section.U32();
+    auto length = section.U64();
+    if (!section.ok || data.size() - section.pos < length) {
+      return nullptr;
+    }
+    NSVIndexReader payload(data, section.pos, section.pos + length);
+    switch (static_cast<NSVIndexSection>(tag)) {
+    case NSVIndexSection::ROW_OFFSETS: {
+      index->row_stride = payload.U64();
+      index->row_count = payload.U64();
+      auto nblocks = payload.U64();
+      if (!payload.ok || index->row_stride == 0 ||
+          nblocks > (payload.end - payload.pos) / 8) {
+        return nullptr;
+      }
+      index->row_offsets.reserve(nblocks);
+      idx_t prev = index->data_start;
+      for (idx_t b = 0; b < nblocks; b++) {
+        auto offset = payload.U64();
+        if (offset < prev || offset >= index->file_size) {
+          return nullptr;
+        }
+        index->row_offsets.push_back(offset);
+        prev = offset;
+      }
+      has_rows = true;
+      break;
+    }
+    case NSVIndexSection::ZONE_MAPS: {
+      auto ncols = payload.U64();
+      if (ncols == 0 || ncols > payload.end - payload.pos) {
+        return nullptr;
+      }
+      for (idx_t c = 0; c < ncols && payload.ok; c++) {
+        index->column_types.push_back(payload.String());
+      }
+      auto nblocks = payload.U64();
+      for (idx_t b = 0; b < nblocks && payload.ok; b++) {
+        vector<NSVZone> block(ncols);
+        for (auto &zone : block) {
+          zone.null_count = payload.U64();
+          zone.has_minmax = payload.U64() != 0;
+          if (zone.has_minmax) {
+            zone.min = payload.String();
+            zone.max = payload.String();
+          }
+        }
+        index->zone_maps.push_back(std::move(block));
+      }
+      if (!payload.ok) {
+        return nullptr;
+      }
+      break;
+    }
+    case NSVIndexSection::BLOOM_FILTERS: {
+      auto nfilters = payload.U64();
+      for (idx_t f = 0; f < nfilters && payload.ok; f++) {
+        NSVBloomFilter filter;
+        filter.column = payload.U64();
+        filter.type = payload.String();
+        auto nblocks = payload.U64();
+        for (idx_t b = 0; b < nblocks && payload.ok; b++) {
+          auto nwords = payload.U64();
+          if (nwords > (payload.end - payload.pos) / 8) {
+            return nullptr;
+          }
+          vector<uint64_t> bits(nwords);
+          for (auto &word : bits) {
+            word = payload.U64();
+          }
+          filter.blocks.push_back(std::move(bits));
+        }
+        if (filter.blocks.size() != nblocks) {
+          return nullptr;
+        }
+        index->bloom_filters.push_back(std::move(filter));
+      }
+      if (!payload.ok) {
+        return nullptr;
+      }
+      break;
+    }
+    default:
+      // Section from a newer writer; skip it.
+      break;
+    }
+    pos = section.pos + length;
+  }
+  if (!has_rows || (!index->zone_maps.empty() &&
+                    index->zone_maps.size() != index->row_offsets.size())) {
+    return nullptr;
+  }
+  for (auto &filter : index->bloom_filters) {
+    if (filter.blocks.size() != index->row_offsets.size()) {
+      return nullptr;
+    }
+  }
+  return index;
+}
+
+string NSVSchema::Serialize() const {
+  string out(NSV_SCHEMA_MAGIC, sizeof(NSV_SCHEMA_MAGIC));
+  NSVPutU64(out, file_size);
+  NSVPutU64(out, static_cast<uint64_t>(file_mtime));
+  NSVPutU64(out, has_header ? 1 : 0);
+  NSVPutU64(out, names.size());
+  for (idx_t c = 0; c < names.size(); c++) {
+    NSVPutString(out, names[c]);
+    NSVPutString(out, types[c]);
+  }
+  return out;
+}
+
+unique_ptr<NSVSchema> NSVSchema::Deserialize(const string &data) {
+  if (data.size() < sizeof(NSV_SCHEMA_MAGIC) ||
+      memcmp(data.data(), NSV_SCHEMA_MAGIC, sizeof(NSV_SCHEMA_MAGIC)) != 0) {
+    return nullptr;
+  }
+  NSVIndexReader reader(data, sizeof(NSV_SCHEMA_MAGIC), data.size());
+  auto schema = make_uniq<NSVSchema>();
+  schema->file_size = reader.U64();
+  schema->file_mtime = static_cast<int64_t>(reader.U64());
+  schema->has_header = (reader.U64() & 1) != 0;
+  auto ncols = reader.U64();
+  if (!reader.ok || ncols == 0 || ncols > reader.end - reader.pos) {
+    return nullptr;
+  }
+  for (idx_t c = 0; c < ncols && reader.ok; c++) {
+    schema->names.push_back(reader.String());
+    schema->types.push_back(reader.String());
+  }
+  if (!reader.ok) {
+    return nullptr;
+  }
+  return schema;
+}
+
+// ── Sidecar files ───────────────────────────────────────────────────
+
+//! Read the whole of `sidecar`; false if it does not exist.
+static bool NSVReadSidecar(FileSystem &fs, const string &sidecar,
+                           string &data) {
+  if (!fs.FileExists(sidecar)) {
+    return false;
+  }
+  auto handle = fs.OpenFile(sidecar, FileFlags::FILE_FLAGS_READ);
+  auto size = fs.GetFileSize(*handle);
+  data.resize(size);
+  fs.Read(*handle, (void *)data.data(), size);
+  return true;
+}
+
+static void NSVWriteSidecar(FileSystem &fs, const string &sidecar,
+                            const string &data) {
+  auto handle = fs.OpenFile(sidecar, FileFlags::FILE_FLAGS_WRITE |
+                                         FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+  fs.Write(*handle, (void *)data.data(), data.size());
+  handle->Close();
+}
+
+unique_ptr<NSVIndex> NSVIndex::TryLoad(FileSystem &fs, const string &path,
+                                       idx_t file_size, int64_t file_mtime,
+                                       bool has_header) {
+  auto sidecar = SidecarPath(path);
+  string data;
+  if (!NSVReadSidecar(fs, sidecar, data)) {
+    return nullptr;
+  }
+  auto index = Deserialize(data);
+  if (!index) {
+    throw IOException("Corrupt NSV index file: %s", sidecar);
+  }
+  if (index->file_size != file_size || index->file_mtime != file_mtime ||
+      index->has_header != has_header) {
+    return nullptr;
+  }
+  return index;
+}
+
+void NSVIndex::Write(FileSystem &fs, const string &path) const {
+  NSVWriteSidecar(fs, SidecarPath(path), Serialize());
+}
+
+unique_ptr<NSVSchema> NSVSchema::TryLoad(FileSystem &fs, const string &path,
+                                         idx_t file_size, int64_t file_mtime,
+                                         bool has_header) {
+  auto sidecar = SidecarPath(path);
+  string data;
+  if (!NSVReadSidecar(fs, sidecar, data)) {
+    return nullptr;
+  }
+  auto schema = Deserialize(data);
+  if (!schema) {
+    throw IOException("Corrupt NSV schema file: %s", sidecar);
+  }
+  if (schema->file_size != file_size || schema->file_mtime != file_mtime ||
+      schema->has_header != has_header) {
+    return nullptr;
+  }
+  return schema;
+}
+
+void NSVSchema::Write(FileSystem &fs, const string &path) const {
+  NSVWriteSidecar(fs, SidecarPath(path), Serialize());
+}
+
+} // namespace duckdb
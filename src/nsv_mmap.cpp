@@ -0,0 +1,171 @@
+#include "nsv_mmap.hpp"
+
+#include "duckdb/common/mutex.hpp"
+
+#include <chrono>
+#include <map>
+#include <tuple>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace duckdb {
+
+NSVMapping::~NSVMapping() {
+#ifndef _WIN32
+  if (data) {
+    munmap(const_cast<uint8_t *>(data), size);
+  }
+#endif
+}
+
+#ifndef _WIN32
+
+//! Modification time of `st` in nanoseconds since the epoch.
+static int64_t NSVStatMtime(const struct stat &st) {
+#ifdef __APPLE__
+  auto &mtime = st.st_mtimespec;
+#else
+  auto &mtime = st.st_mtim;
+#endif
+  return static_cast<int64_t>(mtime.tv_sec) * 1000000000 + mtime.tv_nsec;
+}
+
+bool NSVLocalFileMtime(const string &path, int64_t &mtime) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return false;
+  }
+  mtime = NSVStatMtime(st);
+  return true;
+}
+
+//! Identifies one version of a file: (device, inode, size, mtime).
+using NSVMappingKey = std::tuple<uint64_t, uint64_t, uint64_t, int64_t>;
+
+struct NSVCachedMapping {
+  shared_ptr<NSVMapping> mapping;
+  std::chrono::steady_clock::time_point last_used;
+  //! nsv_mmap_cache_idle_seconds of the bind it was last handed out to.
+  int64_t idle_seconds;
+};
+
+struct NSVMappingCache {
+  mutex lock;
+  std::map<NSVMappingKey, NSVCachedMapping> entries;
+};
+
+static NSVMappingCache &GetMappingCache() {
+  // Leaked on purpose: binds may still drop mappings during static
+  // destruction.
+  static auto *cache = new NSVMappingCache();
+  return *cache;
+}
+
+//! Drop cached mappings that only the cache still holds and that have been
+//! idle for longer than their own idle time.
+static void EvictIdleMappings(NSVMappingCache &cache,
+                              std::chrono::steady_clock::time_point now) {
+  for (auto it = cache.entries.begin(); it != cache.entries.end();) {
+    auto idle = std::chrono::duration_cast<std::chrono::seconds>(
+                    now - it->second.last_used)
+                    .count();
+    if (it->second.mapping.use_count() == 1 &&
+        idle >= it->second.idle_seconds) {
+      it = cache.entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+shared_ptr<NSVMapping> NSVMapFile(const string &path,
+                                  const NSVMappingOptions &options) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+  NSVMappingKey key {static_cast<uint64_t>(st.st_dev),
+                     static_cast<uint64_t>(st.st_ino),
+                     static_cast<uint64_t>(st.st_size),
+                     NSVStatMtime(st)};
+  auto now = std::chrono::steady_clock::now();
+
+  auto &cache = GetMappingCache();
+  lock_guard<mutex> guard(cache.lock);
+  EvictIdleMappings(cache, now);
+  auto entry = cache.entries.find(key);
+  if (entry != cache.entries.end()) {
+    close(fd);
+    entry->second.last_used = now;
+    entry->second.idle_seconds = options.idle_seconds;
+    return entry->second.mapping;
+  }
+
+  int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+  if (options.populate) {
+    flags |= MAP_POPULATE;
+  }
+#endif
+  void *mapped = mmap(nullptr, st.st_size, PROT_READ, flags, fd, 0);
+  // The mapping stays valid without the descriptor.
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  // No whole-file MADV_SEQUENTIAL: threads scan ranges all over the
+  // mapping, and each range is advised when it is claimed.
+#ifdef MADV_HUGEPAGE
+  if (options.hugepages) {
+    madvise(mapped, st.st_size, MADV_HUGEPAGE);
+  }
+#endif
+  auto mapping = make_shared_ptr<NSVMapping>();
+  mapping->data = reinterpret_cast<const uint8_t *>(mapped);
+  mapping->size = static_cast<size_t>(st.st_size);
+  mapping->mtime = NSVStatMtime(st);
+  cache.entries[key] = {mapping, now, options.idle_seconds};
+  return mapping;
+}
+
+void NSVReleaseMapping(shared_ptr<NSVMapping> &mapping) {
+  if (!mapping) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  auto &cache = GetMappingCache();
+  lock_guard<mutex> guard(cache.lock);
+  // Idle time counts from the last release, not from when it was mapped.
+  for (auto &entry : cache.entries) {
+    if (entry.second.mapping == mapping) {
+      entry.second.last_used = now;
+    }
+  }
+  mapping.reset();
+  EvictIdleMappings(cache, now);
+}
+
+#else
+
+void NSVReleaseMapping(shared_ptr<NSVMapping> &mapping) { mapping.reset(); }
+
+bool NSVLocalFileMtime(const string &path, int64_t &mtime) { return false; }
+
+shared_ptr<NSVMapping> NSVMapFile(const string &path,
+                                  const NSVMappingOptions &options) {
+  return nullptr;
+}
+
+#endif
+
+} // namespace duckdb